@@ -0,0 +1,452 @@
+#ifndef ALLOCATORS_H
+#define ALLOCATORS_H
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// allocator over malloc/realloc/free. vector<T,A> picks up reallocate() for
+// trivially relocatable T and grows the block with realloc instead of
+// allocate + copy + deallocate; glibc serves big blocks with mmap and resizes
+// those with mremap, so large vectors usually grow without copying a byte
+template<class T>
+class malloc_allocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U> struct rebind { typedef malloc_allocator<U> other; };
+
+    malloc_allocator() {}
+    template<class U> malloc_allocator(const malloc_allocator<U>&) {}
+
+    T* allocate(size_type n)
+    {
+        if(n==0) return 0;
+        void* p = std::malloc(n*sizeof(T));
+        if(!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_type) { std::free(p); }
+
+    // only valid for trivially relocatable T: the bytes are moved, no constructor runs
+    T* reallocate(T* p, size_type, size_type n)
+    {
+        void* q = std::realloc(p,n*sizeof(T));
+        if(!q) throw std::bad_alloc();     // p is still valid and owned by the caller
+        return static_cast<T*>(q);
+    }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) { ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    template<class U>
+    void destroy(U* p) { p->~U(); }
+};
+
+template<class T, class U>
+bool operator==(const malloc_allocator<T>&, const malloc_allocator<U>&) { return true; }
+
+template<class T, class U>
+bool operator!=(const malloc_allocator<T>&, const malloc_allocator<U>&) { return false; }
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// arenas for request-scoped containers: build, use, throw everything away at once
+
+// bump-pointer allocation from a caller buffer, then (optionally) from chunks
+// taken from malloc. deallocate() does nothing, release() frees it all
+class monotonic_arena {
+    struct chunk { chunk* next; };
+
+    char* cur;
+    char* last;
+    char* buf;
+    std::size_t buf_size;
+    chunk* chunks;
+    std::size_t first_chunk;
+    std::size_t next_chunk;
+    bool fallback;
+
+public:
+    explicit monotonic_arena(std::size_t chunk_size = 64*1024)
+        : cur(0), last(0), buf(0), buf_size(0), chunks(0),
+          first_chunk(chunk_size), next_chunk(chunk_size), fallback(true) {}
+
+    // start in buf; without fallback running out of buf throws std::bad_alloc
+    monotonic_arena(void* b, std::size_t n, bool upstream = true, std::size_t chunk_size = 64*1024)
+        : cur(static_cast<char*>(b)), last(static_cast<char*>(b)+n), buf(static_cast<char*>(b)), buf_size(n),
+          chunks(0), first_chunk(chunk_size), next_chunk(chunk_size), fallback(upstream) {}
+
+    ~monotonic_arena() { release(); }
+
+    void* allocate(std::size_t bytes, std::size_t align)
+    {
+        char* p = align_up(cur,align);
+        if(p==0 || last<p || std::size_t(last-p)<bytes){
+            grow(bytes+align);
+            p = align_up(cur,align);
+        }
+        cur = p+bytes;
+        return p;
+    }
+
+    void deallocate(void*, std::size_t) {}
+
+    void release()
+    {
+        while(chunks){
+            chunk* c = chunks;
+            chunks = c->next;
+            std::free(c);
+        }
+        cur = buf;
+        last = buf+buf_size;
+        next_chunk = first_chunk;
+    }
+
+private:
+    static char* align_up(char* p, std::size_t align)
+    {
+        std::size_t a = reinterpret_cast<std::size_t>(p);
+        return reinterpret_cast<char*>((a+align-1) & ~(align-1));
+    }
+
+    void grow(std::size_t bytes)
+    {
+        if(!fallback) throw std::bad_alloc();
+        std::size_t n = std::max(next_chunk,bytes);
+        chunk* c = static_cast<chunk*>(std::malloc(sizeof(chunk)+n));
+        if(!c) throw std::bad_alloc();
+        c->next = chunks;
+        chunks = c;
+        cur = reinterpret_cast<char*>(c+1);
+        last = cur+n;
+        next_chunk *= 2;    // geometric, so a big request scope takes few mallocs
+    }
+
+    monotonic_arena(const monotonic_arena&);
+    monotonic_arena& operator=(const monotonic_arena&);
+};
+
+// power-of-two size classes with free lists on top of a monotonic_arena, so
+// blocks freed by a growing vector are reused by the next one. blocks above
+// max_block go straight to posix_memalign, at the alignment asked for
+class pool_arena {
+    enum { min_shift = 3, classes = 14 };     // 8 bytes .. 64 KB
+    struct free_block { free_block* next; };
+
+    free_block* free_lists[classes];
+    monotonic_arena upstream;
+
+public:
+    static const std::size_t max_block = std::size_t(1) << (min_shift+classes-1);
+
+    explicit pool_arena(std::size_t chunk_size = 64*1024) : upstream(chunk_size)
+    {
+        std::fill(free_lists,free_lists+classes,static_cast<free_block*>(0));
+    }
+
+    void* allocate(std::size_t bytes, std::size_t align)
+    {
+        if(max_block<bytes){
+            void* p;
+            if(posix_memalign(&p,std::max(align,sizeof(void*)),bytes)!=0) throw std::bad_alloc();
+            return p;
+        }
+        int c = size_class(bytes);
+        free_block* b = free_lists[c];
+        if(b && (reinterpret_cast<std::size_t>(b) & (align-1))==0){  // freed at a smaller alignment: leave it
+            free_lists[c] = b->next;
+            return b;
+        }
+        std::size_t n = std::size_t(1) << (c+min_shift);
+        return upstream.allocate(n,std::max(align,std::min(n,alignof(std::max_align_t))));
+    }
+
+    void deallocate(void* p, std::size_t bytes)
+    {
+        if(max_block<bytes){
+            std::free(p);
+            return;
+        }
+        int c = size_class(bytes);
+        free_block* b = static_cast<free_block*>(p);
+        b->next = free_lists[c];
+        free_lists[c] = b;
+    }
+
+    void release()
+    {
+        std::fill(free_lists,free_lists+classes,static_cast<free_block*>(0));
+        upstream.release();
+    }
+
+private:
+    static int size_class(std::size_t bytes)
+    {
+        int c = 0;
+        while((std::size_t(1) << (c+min_shift))<bytes) ++c;
+        return c;
+    }
+
+    pool_arena(const pool_arena&);
+    pool_arena& operator=(const pool_arena&);
+};
+
+// the allocator vector<T,A> sees: a pointer to the arena, so copies share it
+template<class T, class Arena>
+class arena_allocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U> struct rebind { typedef arena_allocator<U,Arena> other; };
+
+    arena_allocator(Arena& a) : arena(&a) {}
+    template<class U> arena_allocator(const arena_allocator<U,Arena>& o) : arena(o.arena) {}
+
+    T* allocate(size_type n)
+    {
+        return n ? static_cast<T*>(arena->allocate(n*sizeof(T),alignof(T))) : 0;
+    }
+
+    void deallocate(T* p, size_type n) { if(p) arena->deallocate(p,n*sizeof(T)); }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) { ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    template<class U>
+    void destroy(U* p) { p->~U(); }
+
+    Arena* arena;
+};
+
+template<class T, class U, class Arena>
+bool operator==(const arena_allocator<T,Arena>& a, const arena_allocator<U,Arena>& b) { return a.arena==b.arena; }
+
+template<class T, class U, class Arena>
+bool operator!=(const arena_allocator<T,Arena>& a, const arena_allocator<U,Arena>& b) { return a.arena!=b.arena; }
+
+template<class T> using monotonic_allocator = arena_allocator<T,monotonic_arena>;
+template<class T> using pool_allocator = arena_allocator<T,pool_arena>;
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// blocks that start on an Align byte boundary (a cache line by default), so
+// columns of numbers start where vector loads like them to
+
+template<class T, std::size_t Align = 64>
+class aligned_allocator {
+    static_assert((Align & (Align-1))==0 && sizeof(void*)<=Align,"Align must be a power of two, at least a pointer");
+
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U> struct rebind { typedef aligned_allocator<U,Align> other; };
+
+    aligned_allocator() {}
+    template<class U> aligned_allocator(const aligned_allocator<U,Align>&) {}
+
+    T* allocate(size_type n)
+    {
+        if(n==0) return 0;
+        void* p;
+        if(posix_memalign(&p,Align<alignof(T) ? alignof(T) : Align,n*sizeof(T))!=0) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_type) { std::free(p); }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) { ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    template<class U>
+    void destroy(U* p) { p->~U(); }
+};
+
+template<class T, class U, std::size_t Align>
+bool operator==(const aligned_allocator<T,Align>&, const aligned_allocator<U,Align>&) { return true; }
+
+template<class T, class U, std::size_t Align>
+bool operator!=(const aligned_allocator<T,Align>&, const aligned_allocator<U,Align>&) { return false; }
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// allocation tracing, for tests that pin down what an operation costs:
+// tracing_allocator passes every call on to A and records it in an
+// alloc_trace, with its size. constructs are split into copies, moves and
+// the rest. bytes vector moves with memcpy/memmove never reach the
+// allocator, so a trivially relocatable T shows no moves at all
+//
+//  alloc_trace t;
+//  vector<Order,tracing_allocator<Order> > orders((tracing_allocator<Order>(t)));
+//  ...
+//  t.allocations, t.copy_constructs, t.log...
+
+struct alloc_event {
+    enum kind_t { allocate, deallocate, reallocate, construct, copy_construct, move_construct, destroy };
+    kind_t kind;
+    std::size_t count;      // elements
+    std::size_t bytes;      // for reallocate, the new size
+};
+
+// the counters are plain integers: one trace per thread
+struct alloc_trace {
+    alloc_trace() : live_bytes(0), logging(false) { reset(); }
+
+    // zero the counts; live_bytes is what is still allocated, so it stays
+    void reset()
+    {
+        allocations = deallocations = reallocations = 0;
+        bytes_allocated = bytes_deallocated = 0;
+        peak_bytes = live_bytes;
+        constructs = copy_constructs = move_constructs = destroys = 0;
+        log.clear();
+    }
+
+    // old_bytes: what a reallocate started from
+    void record(alloc_event::kind_t kind, std::size_t count, std::size_t bytes, std::size_t old_bytes = 0)
+    {
+        switch(kind){
+        case alloc_event::allocate:
+            ++allocations;
+            bytes_allocated += bytes;
+            live_bytes += bytes;
+            break;
+        case alloc_event::deallocate:
+            ++deallocations;
+            bytes_deallocated += bytes;
+            live_bytes -= bytes;
+            break;
+        case alloc_event::reallocate:
+            ++reallocations;
+            live_bytes += (long long)bytes-(long long)old_bytes;
+            break;
+        case alloc_event::copy_construct: ++copy_constructs; ++constructs; break;
+        case alloc_event::move_construct: ++move_constructs; ++constructs; break;
+        case alloc_event::construct: ++constructs; break;
+        case alloc_event::destroy: ++destroys; break;
+        }
+        if(peak_bytes<live_bytes) peak_bytes = live_bytes;
+        if(logging){
+            alloc_event e = { kind, count, bytes };
+            log.push_back(e);
+        }
+    }
+
+    long long allocations;
+    long long deallocations;
+    long long reallocations;        // blocks resized through A::reallocate
+    long long bytes_allocated;
+    long long bytes_deallocated;
+    long long live_bytes;
+    long long peak_bytes;
+    long long constructs;           // all of them, copies and moves included
+    long long copy_constructs;      // from a single lvalue of the same type
+    long long move_constructs;      // from a single rvalue of the same type
+    long long destroys;
+
+    bool logging;                   // keep every event in log as well
+    std::vector<alloc_event> log;   // std::vector: the trace must not trace itself
+};
+
+namespace alloc_trace_detail {
+
+template<class U, class... Args>
+struct construct_kind { static const alloc_event::kind_t value = alloc_event::construct; };
+
+template<class U, class Arg>
+struct construct_kind<U,Arg> {
+    static const alloc_event::kind_t value =
+        !std::is_same<typename std::decay<Arg>::type,U>::value ? alloc_event::construct
+        : std::is_lvalue_reference<Arg>::value ? alloc_event::copy_construct : alloc_event::move_construct;
+};
+
+}   // namespace alloc_trace_detail
+
+template<class T, class A = std::allocator<T> >
+class tracing_allocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U> struct rebind {
+        typedef tracing_allocator<U,typename std::allocator_traits<A>::template rebind_alloc<U> > other;
+    };
+
+    explicit tracing_allocator(alloc_trace& t, const A& a = A()) : trace(&t), inner(a) {}
+    template<class U, class B> tracing_allocator(const tracing_allocator<U,B>& o) : trace(o.trace), inner(o.inner) {}
+
+    T* allocate(size_type n)
+    {
+        T* p = inner.allocate(n);   // nothing is recorded if A throws
+        trace->record(alloc_event::allocate,n,n*sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, size_type n)
+    {
+        if(!p) return;
+        trace->record(alloc_event::deallocate,n,n*sizeof(T));
+        inner.deallocate(p,n);
+    }
+
+    // only there when A has it, so vector<T,A> sees the same has_reallocate
+    template<class B = A>
+    auto reallocate(T* p, size_type old, size_type n) -> decltype(std::declval<B&>().reallocate(p,old,n))
+    {
+        T* q = inner.reallocate(p,old,n);
+        trace->record(alloc_event::reallocate,n,n*sizeof(T),old*sizeof(T));
+        return q;
+    }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        trace->record(alloc_trace_detail::construct_kind<U,Args...>::value,1,sizeof(U));
+    }
+
+    template<class U>
+    void destroy(U* p)
+    {
+        p->~U();
+        trace->record(alloc_event::destroy,1,sizeof(U));
+    }
+
+    alloc_trace* trace;
+    A inner;
+};
+
+template<class T, class U, class A, class B>
+bool operator==(const tracing_allocator<T,A>& a, const tracing_allocator<U,B>& b) { return a.trace==b.trace && a.inner==b.inner; }
+
+template<class T, class U, class A, class B>
+bool operator!=(const tracing_allocator<T,A>& a, const tracing_allocator<U,B>& b) { return !(a==b); }
+
+#endif // ALLOCATORS_H
@@ -0,0 +1,77 @@
+// build/teardown throughput of short-lived vectors: std::allocator vs arenas
+//
+// each "request" builds a few vectors, reads them and throws them away; the
+// arena is released once per request
+//
+//  usage: bench_arena [requests] [elements per vector]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include "../vector.h"
+#include "../allocators.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<class A>
+long request(const A& a, int n)
+{
+    long sum = 0;
+    for(int k=0 ; k<4 ; ++k){
+        vector<int,A> v(a);
+        for(int i=0 ; i<n ; ++i) v.push_back(i^k);
+        vector<int,A> w(v);
+        for(int i=0 ; i<w.size() ; ++i) sum += w[i];
+    }
+    return sum;
+}
+
+void report(const char* name, bench_clock::time_point t0, int requests, long sum)
+{
+    double ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+    std::cout << name << "\t" << ms << " ms\t" << requests/ms << " krequests/s\t(" << sum << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int requests = argc>1 ? std::atoi(argv[1]) : 200000;
+    int n = argc>2 ? std::atoi(argv[2]) : 100;
+    std::cout << requests << " requests, 8 vectors of " << n << " ints each\n";
+
+    long sum = 0;
+    bench_clock::time_point t0 = bench_clock::now();
+    for(int r=0 ; r<requests ; ++r) sum += request(std::allocator<int>(),n);
+    report("std::allocator     ",t0,requests,sum);
+
+    sum = 0;
+    t0 = bench_clock::now();
+    {
+        monotonic_arena arena;
+        for(int r=0 ; r<requests ; ++r){
+            sum += request(monotonic_allocator<int>(arena),n);
+            arena.release();
+        }
+    }
+    report("monotonic_allocator",t0,requests,sum);
+
+    sum = 0;
+    t0 = bench_clock::now();
+    {
+        static char buf[256*1024];      // the common case never leaves the buffer
+        monotonic_arena arena(buf,sizeof(buf));
+        for(int r=0 ; r<requests ; ++r){
+            sum += request(monotonic_allocator<int>(arena),n);
+            arena.release();
+        }
+    }
+    report("monotonic (buffer) ",t0,requests,sum);
+
+    sum = 0;
+    t0 = bench_clock::now();
+    {
+        pool_arena arena;
+        for(int r=0 ; r<requests ; ++r) sum += request(pool_allocator<int>(arena),n);
+    }
+    report("pool_allocator     ",t0,requests,sum);
+    return 0;
+}
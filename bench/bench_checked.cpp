@@ -0,0 +1,50 @@
+// sort/find through checked_iterator vs raw pointers, per checking policy
+//
+//  build the release flavour with -O2 -DNDEBUG: the unchecked column
+//  should then match the raw one
+//
+//  usage: bench_checked [n]
+
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include "../vector.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<class Vec, class Iter>
+double sort_find(Vec& v, Iter first, Iter last, long& found)
+{
+    bench_clock::time_point t0 = bench_clock::now();
+    std::sort(first,last);
+    for(int k=0 ; k<100 ; ++k)
+        found += std::find(first,last,v[v.size()-1-k]) - first;
+    return std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+}
+
+template<class C>
+void run(const char* name, int n)
+{
+    typedef vector<int,std::allocator<int>,C> vec;
+    vec raw, chk;
+    std::srand(42);
+    for(int i=0 ; i<n ; ++i) raw.push_back(std::rand());
+    chk = raw;
+
+    long found = 0;
+    double t_raw = sort_find(raw,raw.begin(),raw.end(),found);
+    double t_chk = sort_find(chk,chk.checked_begin(),chk.checked_end(),found);
+    std::cout << name << "\traw " << t_raw << " ms\tchecked " << t_chk
+              << " ms\tratio " << t_chk/t_raw << "\t(" << found << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 2000000;
+    std::cout << n << " ints, sort + 100 finds\n";
+    run<unchecked>("unchecked     ",n);
+    run<debug_assert>("debug_assert  ",n);
+    run<throw_on_error>("throw_on_error",n);
+    return 0;
+}
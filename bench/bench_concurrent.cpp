@@ -0,0 +1,51 @@
+// many producers appending: vector<int> behind a mutex vs concurrent_vector<int>
+//
+//  usage: bench_concurrent [n per thread] [threads]
+//  build with -pthread
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../vector.h"
+#include "../concurrent_vector.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<class F>
+double run_threads(int threads, F f)
+{
+    bench_clock::time_point t0 = bench_clock::now();
+    std::vector<std::thread> th;
+    for(int t=0 ; t<threads ; ++t) th.push_back(std::thread(f,t));
+    for(int t=0 ; t<threads ; ++t) th[t].join();
+    return std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 1000000;
+    int threads = argc>2 ? std::atoi(argv[2]) : int(std::thread::hardware_concurrency());
+    if(threads<1) threads = 1;
+    std::cout << threads << " threads x " << n << " push_backs\n";
+
+    vector<int> locked;
+    std::mutex m;
+    double locked_ms = run_threads(threads,[&](int t){
+        for(int i=0 ; i<n ; ++i){
+            std::lock_guard<std::mutex> lock(m);
+            locked.push_back(t*n+i);
+        }
+    });
+
+    concurrent_vector<int> shared;
+    double shared_ms = run_threads(threads,[&](int t){
+        for(int i=0 ; i<n ; ++i) shared.push_back(t*n+i);
+    });
+
+    std::cout << "vector + mutex    \t" << locked_ms << " ms\t(" << locked.size() << ")\n";
+    std::cout << "concurrent_vector \t" << shared_ms << " ms\t(" << shared.size() << ")\t" << locked_ms/shared_ms << "x\n";
+    return 0;
+}
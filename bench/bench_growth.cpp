@@ -0,0 +1,77 @@
+// copies vs moves while growing a vector of strings
+//
+//  usage: bench_growth < words.txt     (same ingestion loop as main())
+//         bench_growth 1000000         (synthetic words when no input is at hand)
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include "../vector.h"
+
+struct counters {
+    static long copies;
+    static long moves;
+    static void reset() { copies = moves = 0; }
+};
+long counters::copies = 0;
+long counters::moves = 0;
+
+// a string that counts how it gets relocated, with a move constructor
+// that may or may not be noexcept (move_if_noexcept copies in the latter case)
+template<bool Noexcept>
+class counted_string {
+    std::string s;
+public:
+    counted_string() {}
+    counted_string(const std::string& x) : s(x) {}
+    counted_string(std::string&& x) : s(std::move(x)) {}
+    counted_string(const counted_string& o) : s(o.s) { ++counters::copies; }
+    counted_string(counted_string&& o) noexcept(Noexcept) : s(std::move(o.s)) { ++counters::moves; }
+    counted_string& operator=(const counted_string& o) { s = o.s; ++counters::copies; return *this; }
+    counted_string& operator=(counted_string&& o) noexcept(Noexcept) { s = std::move(o.s); ++counters::moves; return *this; }
+};
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<class S>
+void run(const char* name, const std::vector<std::string>& words, bool by_move)
+{
+    counters::reset();
+    bench_clock::time_point t0 = bench_clock::now();
+    {
+        vector<S> v;
+        for(std::size_t i=0 ; i<words.size() ; ++i){
+            std::string x = words[i];       // what std::cin>>x hands us
+            if(by_move) v.push_back(S(std::move(x)));
+            else{
+                S tmp(x);
+                v.push_back(tmp);
+            }
+        }
+    }
+    double ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+    std::cout << name << "\t" << ms << " ms\tcopies " << counters::copies
+              << "\tmoves " << counters::moves << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> words;
+    if(argc>1){
+        long n = std::atol(argv[1]);
+        for(long i=0 ; i<n ; ++i) words.push_back("word_number_" + std::to_string(i));
+    }
+    else{
+        std::string x;
+        while(std::cin>>x) words.push_back(x);
+    }
+    std::cout << words.size() << " words\n";
+
+    run<counted_string<false> >("copy-growth push_back(const T&)",words,false);
+    run<counted_string<false> >("copy-growth push_back(T&&)     ",words,true);
+    run<counted_string<true> >("move-growth push_back(const T&)",words,false);
+    run<counted_string<true> >("move-growth push_back(T&&)     ",words,true);
+    return 0;
+}
@@ -0,0 +1,55 @@
+// peak RSS vs throughput per growth policy
+//
+// every policy runs in its own child process, so ru_maxrss is that policy's
+// own high-water mark and not the largest seen so far
+//
+//  usage: bench_growth_policy [n]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../vector.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<class G>
+void fill(int n)
+{
+    bench_clock::time_point t0 = bench_clock::now();
+    vector<long,std::allocator<long>,VECTOR_CHECK_POLICY,G> v;
+    for(int i=0 ; i<n ; ++i) v.push_back(i);
+    double ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+
+    rusage ru;
+    getrusage(RUSAGE_SELF,&ru);
+    std::cout << "\t" << ms << " ms\t" << n/ms/1000 << " Mpush/s\tpeak " << ru.ru_maxrss/1024
+              << " MB\tcapacity " << v.capacity() << " (" << 100.0*(v.capacity()-v.size())/v.capacity()
+              << "% unused)" << std::endl;
+}
+
+template<class G>
+void run(const char* name, int n)
+{
+    std::cout << name << std::flush;
+    pid_t pid = fork();
+    if(pid==0){
+        fill<G>(n);
+        std::_Exit(0);
+    }
+    int status;
+    waitpid(pid,&status,0);
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 50000000;
+    std::cout << n << " longs (" << n*sizeof(long)/(1024*1024) << " MB live)\n";
+    run<double_growth<> >("double_growth      ",n);
+    run<golden_growth<> >("golden_growth      ",n);
+    run<size_class_growth<> >("size_class_growth  ",n);
+    run<chunk_growth<1<<20> >("chunk_growth<1M>   ",n);
+    return 0;
+}
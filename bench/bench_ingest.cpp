@@ -0,0 +1,67 @@
+// tokenizing a file into vector<std::string>: operator>> vs ingest vs read_tokens
+//
+//  usage: bench_ingest [MB of text]
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../vector.h"
+#include "../ingest.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+void report(const char* name, bench_clock::time_point t0, int tokens, double mb)
+{
+    double ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+    std::cout << name << "\t" << ms << " ms\t" << mb/ms*1000 << " MB/s\t" << tokens << " tokens\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int mb = argc>1 ? std::atoi(argv[1]) : 200;
+    const char* path = "bench_ingest.txt";
+    {
+        std::ofstream out(path,std::ios::binary);
+        unsigned long x = 88172645463325252UL;
+        std::string line;
+        for(long bytes=0 ; bytes<mb*1024L*1024 ; bytes+=line.size()){
+            line.clear();
+            for(int w=0 ; w<12 ; ++w){
+                x ^= x<<13; x ^= x>>7; x ^= x<<17;
+                line.append("lorem ipsum dolor sit amet consectetur adipiscing elit"+x%50,1+x%9);
+                line += w==11 ? '\n' : ' ';
+            }
+            out << line;
+        }
+    }
+    std::cout << mb << " MB of text\n";
+
+    {
+        bench_clock::time_point t0 = bench_clock::now();
+        std::ifstream in(path);
+        vector<std::string> v;
+        std::string x;
+        while(in>>x) v.push_back(x);
+        report("operator>>   ",t0,v.size(),mb);
+    }
+    {
+        bench_clock::time_point t0 = bench_clock::now();
+        std::ifstream in(path);
+        vector<std::string> v;
+        ingest(in,v);
+        report("ingest       ",t0,v.size(),mb);
+    }
+    {
+        bench_clock::time_point t0 = bench_clock::now();
+        int fd = open(path,O_RDONLY);
+        vector<std::string> v;
+        read_tokens(fd,v);
+        close(fd);
+        report("read_tokens  ",t0,v.size(),mb);
+    }
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// parallel_sort / for_each / transform / reduce / find scaling, 1..N threads
+//
+// each thread count gets its own thread_pool; the 1 thread row is the
+// sequential baseline the speedup column is measured against
+//
+//  usage: bench_parallel [n] [max threads]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include "../vector.h"
+#include "../parallel.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+double since(bench_clock::time_point t0)
+{
+    return std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 20000000;
+    unsigned max_threads = argc>2 ? unsigned(std::atoi(argv[2])) : std::thread::hardware_concurrency();
+    if(max_threads==0) max_threads = 1;
+
+    vector<long> input;
+    input.reserve(n);
+    unsigned long x = 88172645463325252UL;
+    for(int i=0 ; i<n ; ++i){
+        x ^= x<<13; x ^= x>>7; x ^= x<<17;
+        input.push_back(long(x>>1));
+    }
+    std::cout << n << " longs, up to " << max_threads << " threads\n";
+    std::cout << "threads\tsort ms\tx\tfor_each\ttransform\treduce\tfind ms\n";
+
+    double base = 0;
+    for(unsigned t=1 ; ; t = std::min(2*t,max_threads)){
+        thread_pool pool(t);
+        vector<long> v(input);
+        vector<long> out(n);
+        typedef vector<long>::checked_iterator checked;
+
+        bench_clock::time_point t0 = bench_clock::now();
+        parallel_sort(checked(&v,v.begin()),checked(&v,v.end()),std::less<long>(),pool);
+        double sort_ms = since(t0);
+        if(t==1) base = sort_ms;
+
+        t0 = bench_clock::now();
+        parallel_for_each(v.begin(),v.end(),[](long& e){ e = e/3+1; },pool);
+        double each_ms = since(t0);
+
+        t0 = bench_clock::now();
+        parallel_transform(v.begin(),v.end(),out.begin(),[](long e){ return e*e%1000003; },pool);
+        double transform_ms = since(t0);
+
+        t0 = bench_clock::now();
+        long sum = parallel_reduce(out.begin(),out.end(),0L,pool);
+        double reduce_ms = since(t0);
+
+        t0 = bench_clock::now();
+        long* hit = parallel_find(v.begin(),v.end(),-1L,pool);     // not there: a full scan
+        double find_ms = since(t0);
+
+        std::cout << t << "\t" << sort_ms << "\t" << base/sort_ms << "\t" << each_ms << "\t\t" << transform_ms
+                  << "\t\t" << reduce_ms << "\t" << find_ms << "\t(" << sum%1000 << (hit==v.end() ? "" : " !") << ")\n";
+        if(t==max_threads) break;
+    }
+    return 0;
+}
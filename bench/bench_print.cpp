@@ -0,0 +1,70 @@
+// dumping a vector: the old cout-per-element print vs bulk_writer
+//
+// both write the same text to stdout, timings go to stderr:
+//
+//  bench_print [n] > /dev/null
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include "../vector.h"
+#include "../bulk_writer.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<typename T>
+void print_cout(const vector<T>& v)     // print() as it was
+{
+    std::cout << "v.size() == " << v.size() << " v.capacity() == " << v.capacity() << std::endl;
+    for(int i=0 ; i<v.size() ; ++i)
+        std::cout << "v[" << i << "] == "<< v[i] << '\n';
+    std::cout << "\n";
+}
+
+template<typename T>
+void print_bulk(const vector<T>& v)
+{
+    bulk_writer& out = stdout_writer();
+    out << "v.size() == " << v.size() << " v.capacity() == " << v.capacity() << '\n';
+    for(int i=0 ; i<v.size() ; ++i)
+        out << "v[" << i << "] == " << v[i] << '\n';
+    out << '\n';
+    out.flush();
+}
+
+template<class V, class F>
+void run(const char* name, const V& v, F print)
+{
+    bench_clock::time_point t0 = bench_clock::now();
+    print(v);
+    double ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+    std::cerr << name << "\t" << ms << " ms\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 1000000;
+    vector<long> longs;
+    vector<double> doubles;
+    vector<std::string> strings;
+    unsigned long x = 88172645463325252UL;
+    for(int i=0 ; i<n ; ++i){
+        x ^= x<<13; x ^= x>>7; x ^= x<<17;
+        longs.push_back(long(x%2000000000)-1000000000);
+        doubles.push_back(double(x%1000000)/997);
+        strings.push_back(std::string("token")+char('a'+x%26));
+    }
+    std::cerr << n << " elements per vector\n";
+
+    run("long   cout",longs,print_cout<long>);
+    std::cout.flush();
+    run("long   bulk",longs,print_bulk<long>);
+    run("double cout",doubles,print_cout<double>);
+    std::cout.flush();
+    run("double bulk",doubles,print_bulk<double>);
+    run("string cout",strings,print_cout<std::string>);
+    std::cout.flush();
+    run("string bulk",strings,print_bulk<std::string>);
+    return 0;
+}
@@ -0,0 +1,75 @@
+// std algorithms vs the simd_ kernels over a vector<float>, and find over
+// checked iterators (the way main_v1.cpp searches) vs find on a checked_range
+//
+//  usage: bench_simd [n] [repeats]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include "../vector.h"
+#include "../checked_range.h"
+#include "../simd.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+template<class F>
+double time_ms(int repeats, F f)
+{
+    bench_clock::time_point t0 = bench_clock::now();
+    for(int k=0 ; k<repeats ; ++k) f();
+    return std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+}
+
+void report(const char* what, double std_ms, double simd_ms)
+{
+    std::cout << what << "\tstd " << std_ms << " ms\tsimd " << simd_ms << " ms\t" << std_ms/simd_ms << "x\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 1000000;
+    int repeats = argc>2 ? std::atoi(argv[2]) : 200;
+
+    simd_vector<float> a, b;
+    a.reserve(n);
+    b.reserve(n);
+    for(int i=0 ; i<n ; ++i){
+        a.push_back(float(i%1000));
+        b.push_back(float(i%7));
+    }
+    a.back() = -1;      // what find looks for: the whole vector is scanned
+    std::cout << n << " floats, " << repeats << " passes, kernels for " << simd_dispatch_isa() << "\n";
+
+    volatile double sink = 0;
+    report("find   ",
+           time_ms(repeats,[&]{ sink = std::find(a.begin(),a.end(),-1.0f)-a.begin(); }),
+           time_ms(repeats,[&]{ sink = simd_find(a.begin(),a.end(),-1.0f)-a.begin(); }));
+    report("count  ",
+           time_ms(repeats,[&]{ sink = std::count(a.begin(),a.end(),3.0f); }),
+           time_ms(repeats,[&]{ sink = simd_count(a.begin(),a.end(),3.0f); }));
+    report("min    ",
+           time_ms(repeats,[&]{ sink = *std::min_element(a.begin(),a.end()); }),
+           time_ms(repeats,[&]{ sink = simd_min(a.begin(),a.end()); }));
+    report("sum    ",
+           time_ms(repeats,[&]{ sink = std::accumulate(a.begin(),a.end(),0.0f); }),
+           time_ms(repeats,[&]{ sink = simd_sum(a.begin(),a.end()); }));
+    report("dot    ",
+           time_ms(repeats,[&]{ sink = std::inner_product(a.begin(),a.end(),b.begin(),0.0f); }),
+           time_ms(repeats,[&]{ sink = simd_dot(a.begin(),a.end(),b.begin()); }));
+    report("equal  ",
+           time_ms(repeats,[&]{ sink = std::equal(a.begin(),a.end(),a.begin()); }),
+           time_ms(repeats,[&]{ sink = simd_equal(a.begin(),a.end(),a.begin()); }));
+    report("scale  ",
+           time_ms(repeats,[&]{ std::transform(a.begin(),a.end(),b.begin(),[](float x){ return x*2; }); }),
+           time_ms(repeats,[&]{ simd_scale(a.begin(),a.end(),2,b.begin()); }));
+
+    // the checked search: ++ and * checked per element vs one check up front
+    typedef simd_vector<float>::const_checked_iterator citer;
+    const simd_vector<float>& ca = a;
+    report("find checked",
+           time_ms(repeats,[&]{ sink = std::find(citer(&ca,ca.begin()),citer(&ca,ca.end()),-1.0f).plain_iterator()-ca.begin(); }),
+           time_ms(repeats,[&]{ sink = find(make_checked_range(citer(&ca,ca.begin()),citer(&ca,ca.end())),-1.0f).plain_iterator()-ca.begin(); }));
+    return 0;
+}
@@ -0,0 +1,71 @@
+// checkpoint/restore of a big vector: snapshot save, load and view
+//
+//  usage: bench_snapshot [n]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include "../vector.h"
+#include "../snapshot.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+void report(const char* name, bench_clock::time_point t0, double mb)
+{
+    double ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+    std::cout << name << "\t" << ms << " ms";
+    if(mb>0) std::cout << "\t" << mb/ms*1000 << " MB/s";
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 50000000;
+    const char* path = "bench_snapshot.bin";
+
+    vector<long> v;
+    v.reserve(n);
+    for(int i=0 ; i<n ; ++i) v.push_back(long(i)*2654435761L);
+    double mb = double(n)*sizeof(long)/(1024*1024);
+    std::cout << n << " longs (" << mb << " MB)\n";
+
+    bench_clock::time_point t0 = bench_clock::now();
+    save_snapshot(path,v);
+    report("save              ",t0,mb);
+
+    t0 = bench_clock::now();
+    vector<long> w;
+    load_snapshot(path,w);
+    report("load              ",t0,mb);
+
+    t0 = bench_clock::now();
+    {
+        vector<long> u;
+        load_snapshot(path,u,false);
+    }
+    report("load, no checksum ",t0,mb);
+
+    t0 = bench_clock::now();
+    long probe = 0;
+    {
+        snapshot_view<long> view(path,false);
+        probe = view[n/2];
+    }
+    report("view, no checksum ",t0,mb);
+    if(w.size()!=n || probe!=v[n/2]) std::cerr << "mismatch\n";
+
+    vector<std::string> s;
+    for(int i=0 ; i<n/10 ; ++i) s.push_back(std::to_string(v[i]));
+    t0 = bench_clock::now();
+    save_snapshot(path,s);
+    report("save strings      ",t0,0);
+    t0 = bench_clock::now();
+    vector<std::string> s2;
+    load_snapshot(path,s2);
+    report("load strings      ",t0,0);
+
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,62 @@
+// one field out of a wide record: vector<Record> vs soa_vector columns
+//
+//  usage: bench_soa [n] [repeats]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include "../vector.h"
+#include "../soa_vector.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+struct Record {
+    float price;
+    float weight;
+    int id;
+    int flags;
+    double extra[4];
+};
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 4000000;
+    int repeats = argc>2 ? std::atoi(argv[2]) : 20;
+
+    vector<Record> aos;
+    soa_vector<float,float,int,int,double,double,double,double> soa;
+    aos.reserve(n);
+    soa.reserve(n);
+    for(int i=0 ; i<n ; ++i){
+        Record r = { float(i%1000)/10, float(i%7), i, i&3, { 0, 0, 0, 0 } };
+        aos.push_back(r);
+        soa.push_back(r.price,r.weight,r.id,r.flags,0,0,0,0);
+    }
+    std::cout << n << " records of " << sizeof(Record) << " bytes, " << repeats << " passes\n";
+
+    bench_clock::time_point t0 = bench_clock::now();
+    float sum = 0;
+    for(int k=0 ; k<repeats ; ++k){
+        float s = 0;
+        for(int i=0 ; i<aos.size() ; ++i) s += aos[i].price*aos[i].weight;
+        sum += s;
+    }
+    double aos_ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+
+    t0 = bench_clock::now();
+    float sum2 = 0;
+    for(int k=0 ; k<repeats ; ++k){
+        column_span<float> price = soa.column<0>();
+        column_span<float> weight = soa.column<1>();
+        const float* p = price.data();
+        const float* w = weight.data();
+        float s = 0;
+        for(int i=0 ; i<price.size() ; ++i) s += p[i]*w[i];
+        sum2 += s;
+    }
+    double soa_ms = std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+
+    std::cout << "vector<Record> \t" << aos_ms << " ms\t(" << sum << ")\n";
+    std::cout << "soa_vector     \t" << soa_ms << " ms\t(" << sum2 << ")\t" << aos_ms/soa_ms << "x\n";
+    return 0;
+}
@@ -0,0 +1,46 @@
+// what the instrumented<> policy costs: push_back/insert/erase on a plain
+// vector<int> vs one counting into vector_stats, then the counters as JSON
+//
+//  usage: bench_stats [n] [repeats]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include "../vector.h"
+#include "../vector_stats.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+struct bench_tag { static const char* name() { return "bench_stats"; } };
+
+template<class V>
+double run(int n, int repeats, long& sum)
+{
+    bench_clock::time_point t0 = bench_clock::now();
+    sum = 0;
+    for(int k=0 ; k<repeats ; ++k){
+        V v;
+        for(int i=0 ; i<n ; ++i) v.push_back(i);
+        for(int i=0 ; i<200 ; ++i) v.insert(v.begin()+v.size()/2,i);
+        for(int i=0 ; i<200 ; ++i) v.erase(v.begin()+v.size()/3);
+        sum += v[v.size()/2];
+    }
+    return std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 100000;
+    int repeats = argc>2 ? std::atoi(argv[2]) : 50;
+    std::cout << n << " push_backs, 200 inserts and 200 erases, " << repeats << " times\n";
+
+    long sum, sum2;
+    double plain = run<vector<int> >(n,repeats,sum);
+    double counted = run<vector<int,std::allocator<int>,instrumented<bench_tag> > >(n,repeats,sum2);
+    std::cout << "plain        \t" << plain << " ms\t(" << sum << ")\n";
+    std::cout << "instrumented \t" << counted << " ms\t(" << sum2 << ")\t" << counted/plain << "x\n";
+
+    vector_stats_registry::instance().dump_json(std::cout);
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,60 @@
+// string_sort vs std::sort on the same vector<std::string>
+//
+// words are short and drawn from a skewed alphabet, like tokens read from
+// text: most fit the SSO buffer and many share long prefixes
+//
+//  usage: bench_string_sort [n words]
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "../vector.h"
+#include "../string_sort.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+double since(bench_clock::time_point t0)
+{
+    return std::chrono::duration<double,std::milli>(bench_clock::now()-t0).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int n = argc>1 ? std::atoi(argv[1]) : 2000000;
+
+    vector<std::string> words;
+    words.reserve(n);
+    unsigned long x = 88172645463325252UL;
+    for(int i=0 ; i<n ; ++i){
+        std::string w;
+        x ^= x<<13; x ^= x>>7; x ^= x<<17;
+        int len = 3+int(x%14);
+        for(int k=0 ; k<len ; ++k){
+            x ^= x<<13; x ^= x>>7; x ^= x<<17;
+            w += "eeeettaoinshrdlcumwfgypbvkjxqz"[(x%30)*(x%30)/30];
+        }
+        words.push_back(std::move(w));
+    }
+    std::cout << n << " words\n";
+
+    vector<std::string> a(words);
+    bench_clock::time_point t0 = bench_clock::now();
+    std::sort(a.begin(),a.end());
+    double std_ms = since(t0);
+    std::cout << "std::sort    \t" << std_ms << " ms\n";
+
+    vector<std::string> b(words);
+    t0 = bench_clock::now();
+    string_sort(b);
+    double radix_ms = since(t0);
+    std::cout << "string_sort  \t" << radix_ms << " ms\t" << std_ms/radix_ms << "x\n";
+
+    for(int i=0 ; i<n ; ++i)
+        if(a[i]!=b[i]){
+            std::cerr << "mismatch at " << i << "\n";
+            return 1;
+        }
+    return 0;
+}
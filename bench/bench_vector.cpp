@@ -0,0 +1,479 @@
+// the container benchmark suite: push_back, push_front, insert, erase,
+// reserve, copy, assign, sort and find over int, std::string and a 64 byte
+// struct, for sizes 10, 100, ... up to --max_size, on vector and
+// std::vector, and through raw pointers, checked_iterators (throw_on_error)
+// and checked_range. a small harness in the manner of Google Benchmark: each
+// case repeats until it has run --benchmark_min_time seconds, and prints a
+// console table, CSV or JSON with the same columns and flags, so the output
+// can be compared from one release to the next with the usual tools
+//
+//  usage: bench_vector [--benchmark_filter=<regex>] [--benchmark_min_time=<s>]
+//                      [--benchmark_format=console|csv|json]
+//                      [--benchmark_out=<file>] [--benchmark_out_format=csv|json]
+//                      [--benchmark_list_tests] [--max_size=<n, default 1000000>]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../vector.h"
+#include "../checked_range.h"
+
+namespace bench {
+
+typedef std::chrono::steady_clock clock_type;
+
+inline double cpu_now()     // seconds of CPU time used by the process
+{
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&t);
+    return t.tv_sec+t.tv_nsec*1e-9;
+}
+
+// what a benchmark body sees: while(st.keep_running()) { ... } runs the timed
+// iterations, pause()/resume() keep per-iteration setup out of the timing
+class state {
+public:
+    state(long iterations, long n) : n(n), remaining(iterations), started(false), paused_real(0), paused_cpu(0) {}
+
+    bool keep_running()
+    {
+        if(!started){
+            started = true;
+            t0 = clock_type::now();
+            c0 = cpu_now();
+        }
+        if(0<remaining--) return true;
+        t1 = clock_type::now();
+        c1 = cpu_now();
+        return false;
+    }
+
+    void pause()
+    {
+        p0 = clock_type::now();
+        pc0 = cpu_now();
+    }
+
+    void resume()
+    {
+        paused_real += std::chrono::duration<double>(clock_type::now()-p0).count();
+        paused_cpu += cpu_now()-pc0;
+    }
+
+    double real_seconds() const { return std::chrono::duration<double>(t1-t0).count()-paused_real; }
+    double cpu_seconds() const { return c1-c0-paused_cpu; }
+
+    const long n;   // the size the case runs at
+
+private:
+    long remaining;
+    bool started;
+    clock_type::time_point t0, t1, p0;
+    double c0, c1, pc0;
+    double paused_real, paused_cpu;
+};
+
+struct bench_case {
+    std::string name;
+    long n;
+    long items;     // per iteration, for items_per_second
+    std::function<void(state&)> body;
+};
+
+struct result {
+    std::string name;
+    long iterations;
+    double real_ns, cpu_ns;     // per iteration
+    double items_per_second;
+};
+
+inline std::vector<bench_case>& registry()
+{
+    static std::vector<bench_case> cases;
+    return cases;
+}
+
+inline void add(const std::string& name, long n, long items, std::function<void(state&)> body)
+{
+    bench_case c = { name+"/"+std::to_string(n), n, items, body };
+    registry().push_back(c);
+}
+
+// Google Benchmark's way: run, and if that was too short to time, run again
+// with as many iterations as should fill min_time (at most 10x more each round)
+inline result run(const bench_case& c, double min_time)
+{
+    long iterations = 1;
+    for(;;){
+        state st(iterations,c.n);
+        c.body(st);
+        double t = st.real_seconds();
+        if(min_time<=t || 1000000000<=iterations){
+            result r = { c.name, iterations, t*1e9/iterations, st.cpu_seconds()*1e9/iterations,
+                         t>0 ? double(c.items)*iterations/t : 0 };
+            return r;
+        }
+        double want = t>0 ? min_time*1.4/t*iterations : iterations*10.0;
+        long next = long(want);
+        if(iterations*10<next) next = iterations*10;
+        iterations = next<=iterations ? iterations+1 : next;
+    }
+}
+
+inline void console_header(std::ostream& os, std::size_t width)
+{
+    os << std::left << std::setw(int(width)) << "Benchmark" << std::right
+       << std::setw(15) << "Time" << std::setw(15) << "CPU" << std::setw(13) << "Iterations"
+       << std::setw(14) << "items/s" << "\n"
+       << std::string(width+57,'-') << "\n";
+}
+
+inline std::string rate(double r)
+{
+    const char* unit[] = { "", "k", "M", "G", "T" };
+    int u = 0;
+    for( ; 1000<=r && u<4 ; ++u) r /= 1000;
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(r<10 ? 2 : r<100 ? 1 : 0) << r << unit[u] << "/s";
+    return s.str();
+}
+
+inline void console_row(std::ostream& os, const result& r, std::size_t width)
+{
+    os << std::left << std::setw(int(width)) << r.name << std::right << std::fixed << std::setprecision(0)
+       << std::setw(12) << r.real_ns << " ns" << std::setw(12) << r.cpu_ns << " ns"
+       << std::setw(13) << r.iterations << std::setw(14) << rate(r.items_per_second) << "\n";
+    os.unsetf(std::ios::floatfield);
+}
+
+inline void csv(std::ostream& os, const std::vector<result>& rs)
+{
+    os << "name,iterations,real_time,cpu_time,time_unit,items_per_second\n";
+    for(std::size_t i=0 ; i<rs.size() ; ++i)
+        os << '"' << rs[i].name << "\"," << rs[i].iterations << ',' << rs[i].real_ns << ','
+           << rs[i].cpu_ns << ",ns," << rs[i].items_per_second << "\n";
+}
+
+inline void json(std::ostream& os, const std::vector<result>& rs)
+{
+    char date[64];
+    std::time_t now = std::time(0);
+    std::strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%S%z",std::localtime(&now));
+    os << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"executable\": \"bench_vector\",\n"
+       << "    \"library_build_type\": \""
+#ifdef NDEBUG
+       << "release"
+#else
+       << "debug"
+#endif
+       << "\"\n  },\n  \"benchmarks\": [";
+    for(std::size_t i=0 ; i<rs.size() ; ++i)
+        os << (i ? ",\n" : "\n") << "    {\"name\": \"" << rs[i].name << "\", \"run_type\": \"iteration\", \"iterations\": "
+           << rs[i].iterations << ", \"real_time\": " << rs[i].real_ns << ", \"cpu_time\": " << rs[i].cpu_ns
+           << ", \"time_unit\": \"ns\", \"items_per_second\": " << rs[i].items_per_second << "}";
+    os << "\n  ]\n}\n";
+}
+
+}   // namespace bench
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// element types and their test data
+
+struct pod64 {
+    long long key;
+    char pad[56];
+};
+static_assert(sizeof(pod64)==64,"a cache line per element");
+
+inline bool operator<(const pod64& a, const pod64& b) { return a.key<b.key; }
+inline bool operator==(const pod64& a, const pod64& b) { return a.key==b.key; }
+
+template<class T> struct data;
+
+template<> struct data<int> {
+    static const char* name() { return "int"; }
+    static int make(unsigned long long r) { return int(r>>33); }
+    static int absent() { return -1; }
+};
+
+template<> struct data<std::string> {
+    static const char* name() { return "string"; }
+    static std::string make(unsigned long long r)  // 8 to 39 chars: some in the SSO buffer, most not
+    {
+        std::string s = std::to_string(r);
+        s.resize(8+(r>>59),'x');
+        return s;
+    }
+    static std::string absent() { return "absent"; }
+};
+
+template<> struct data<pod64> {
+    static const char* name() { return "pod64"; }
+    static pod64 make(unsigned long long r)
+    {
+        pod64 p;
+        p.key = (long long)(r>>1);
+        std::memset(p.pad,int(r&0xff),sizeof(p.pad));
+        return p;
+    }
+    static pod64 absent() { pod64 p = make(0); p.key = -1; return p; }
+};
+
+template<class T>
+std::vector<T> source(long n)
+{
+    std::mt19937_64 g(42);
+    std::vector<T> s;
+    s.reserve(n);
+    for(long i=0 ; i<n ; ++i) s.push_back(data<T>::make(g()));
+    return s;
+}
+
+// the containers under test; vector checks with throw_on_error, so its
+// checked_iterators check whatever the build type
+template<class T> struct ours {
+    typedef vector<T,std::allocator<T>,throw_on_error> type;
+    static const char* name() { return "vector"; }
+};
+template<class T> struct theirs {
+    typedef std::vector<T> type;
+    static const char* name() { return "std::vector"; }
+};
+
+template<class T, class A, class C, class G>
+void push_front(vector<T,A,C,G>& v, const T& x) { v.push_front(x); }
+template<class T>
+void push_front(std::vector<T>& v, const T& x) { v.insert(v.begin(),x); }     // all std::vector has
+
+template<class V, class T>
+void fill(V& v, const std::vector<T>& src) { v.assign(src.begin(),src.end()); }
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// the cases
+
+template<template<class> class K, class T>
+void register_container(long n)
+{
+    typedef typename K<T>::type V;
+    std::string tag = std::string(K<T>::name())+"/"+data<T>::name();
+
+    bench::add(std::string("push_back/")+tag,n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        while(st.keep_running()){
+            V v;
+            for(long i=0 ; i<st.n ; ++i) v.push_back(src[i]);
+        }
+    });
+
+    if(K<T>::name()==std::string("vector") || n<=10000)    // quadratic on std::vector
+        bench::add(std::string("push_front/")+tag,n,n,[](bench::state& st){
+            std::vector<T> src = source<T>(st.n);
+            while(st.keep_running()){
+                V v;
+                for(long i=0 ; i<st.n ; ++i) push_front(v,src[i]);
+            }
+        });
+
+    bench::add(std::string("insert_middle/")+tag,n,1,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        fill(v,src);
+        T x = src[0];
+        while(st.keep_running()){
+            v.insert(v.begin()+v.size()/2,x);
+            v.pop_back();
+        }
+    });
+
+    bench::add(std::string("erase_middle/")+tag,n,1,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        fill(v,src);
+        T x = src[0];
+        while(st.keep_running()){
+            v.erase(v.begin()+v.size()/2);
+            v.push_back(x);
+        }
+    });
+
+    bench::add(std::string("reserve_push_back/")+tag,n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        while(st.keep_running()){
+            V v;
+            v.reserve(int(st.n));
+            for(long i=0 ; i<st.n ; ++i) v.push_back(src[i]);
+        }
+    });
+
+    bench::add(std::string("copy/")+tag,n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        fill(v,src);
+        while(st.keep_running()){
+            V w(v);
+            if(w.size()!=v.size()) std::abort();
+        }
+    });
+
+    bench::add(std::string("assign/")+tag,n,n,[](bench::state& st){     // into enough capacity
+        std::vector<T> src = source<T>(st.n);
+        V v, w;
+        fill(v,src);
+        fill(w,src);
+        while(st.keep_running()) w = v;
+    });
+
+    bench::add(std::string("sort/")+tag+"/raw",n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        while(st.keep_running()){
+            st.pause();
+            fill(v,src);
+            st.resume();
+            std::sort(v.begin(),v.end());
+        }
+    });
+
+    bench::add(std::string("find/")+tag+"/raw",n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        fill(v,src);
+        T x = data<T>::absent();
+        while(st.keep_running())
+            if(std::find(v.begin(),v.end(),x)!=v.end()) std::abort();
+    });
+}
+
+// what only vector has: its checked_iterators, and checked_range
+template<class T>
+void register_checked(long n)
+{
+    typedef typename ours<T>::type V;
+    typedef typename V::checked_iterator It;
+    std::string tag = std::string("vector/")+data<T>::name();
+
+    bench::add(std::string("sort/")+tag+"/checked",n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        while(st.keep_running()){
+            st.pause();
+            fill(v,src);
+            st.resume();
+            std::sort(It(&v,v.begin()),It(&v,v.end()));
+        }
+    });
+
+    bench::add(std::string("sort/")+tag+"/checked_range",n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        while(st.keep_running()){
+            st.pause();
+            fill(v,src);
+            st.resume();
+            sort(make_checked_range(It(&v,v.begin()),It(&v,v.end())));
+        }
+    });
+
+    bench::add(std::string("find/")+tag+"/checked",n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        fill(v,src);
+        T x = data<T>::absent();
+        while(st.keep_running())
+            if(std::find(It(&v,v.begin()),It(&v,v.end()),x)!=v.end()) std::abort();
+    });
+
+    bench::add(std::string("find/")+tag+"/checked_range",n,n,[](bench::state& st){
+        std::vector<T> src = source<T>(st.n);
+        V v;
+        fill(v,src);
+        T x = data<T>::absent();
+        while(st.keep_running())
+            if(find(make_checked_range(It(&v,v.begin()),It(&v,v.end())),x)!=It(&v,v.end())) std::abort();
+    });
+}
+
+template<class T>
+void register_type(long max_size)
+{
+    for(long n=10 ; n<=max_size ; n*=10){
+        register_container<ours,T>(n);
+        register_container<theirs,T>(n);
+        register_checked<T>(n);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter, format = "console", out, out_format = "json";
+    double min_time = 0.1;
+    long max_size = 1000000;
+    bool list = false;
+    for(int i=1 ; i<argc ; ++i){
+        std::string a = argv[i];
+        std::string v = a.find('=')==std::string::npos ? "" : a.substr(a.find('=')+1);
+        if(a.compare(0,19,"--benchmark_filter=")==0) filter = v;
+        else if(a.compare(0,21,"--benchmark_min_time=")==0) min_time = std::atof(v.c_str());
+        else if(a.compare(0,19,"--benchmark_format=")==0) format = v;
+        else if(a.compare(0,16,"--benchmark_out=")==0) out = v;
+        else if(a.compare(0,23,"--benchmark_out_format=")==0) out_format = v;
+        else if(a=="--benchmark_list_tests" || a=="--benchmark_list_tests=true") list = true;
+        else if(a.compare(0,11,"--max_size=")==0) max_size = long(std::atof(v.c_str()));
+        else{
+            std::cerr << "bench_vector: unknown option " << a << "\n";
+            return 1;
+        }
+    }
+    if(format!="console" && format!="csv" && format!="json"){
+        std::cerr << "bench_vector: --benchmark_format is console, csv or json\n";
+        return 1;
+    }
+
+    register_type<int>(max_size);
+    register_type<std::string>(max_size);
+    register_type<pod64>(max_size);
+
+    std::regex re(filter.empty() ? "." : filter);
+    std::vector<const bench::bench_case*> todo;
+    std::size_t width = 10;
+    for(std::size_t i=0 ; i<bench::registry().size() ; ++i)
+        if(std::regex_search(bench::registry()[i].name,re)){
+            todo.push_back(&bench::registry()[i]);
+            width = std::max(width,bench::registry()[i].name.size()+2);
+        }
+    if(list){
+        for(std::size_t i=0 ; i<todo.size() ; ++i) std::cout << todo[i]->name << "\n";
+        return 0;
+    }
+
+    std::vector<bench::result> results;
+    if(format=="console") bench::console_header(std::cout,width);
+    for(std::size_t i=0 ; i<todo.size() ; ++i){
+        results.push_back(bench::run(*todo[i],min_time));
+        if(format=="console") bench::console_row(std::cout,results.back(),width);
+    }
+    if(format=="csv") bench::csv(std::cout,results);
+    if(format=="json") bench::json(std::cout,results);
+
+    if(!out.empty()){
+        std::ofstream f(out.c_str());
+        if(!f){
+            std::cerr << "bench_vector: can't write " << out << "\n";
+            return 1;
+        }
+        if(out_format=="csv") bench::csv(f,results);
+        else bench::json(f,results);
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+#ifndef BULK_WRITER_H
+#define BULK_WRITER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <type_traits>
+#include <system_error>
+#include <unistd.h>
+
+// formatted output into one big reusable buffer, handed to write(2) when it
+// fills up or on flush(). integers are formatted by hand, two digits at a
+// time, floating point goes through snprintf("%g") (what ostream prints by
+// default), strings are memcpy'd. nothing is locale aware and nothing syncs
+// with stdio: don't mix it with std::cout on the same fd without flushing
+class bulk_writer {
+public:
+    explicit bulk_writer(int fd = 1, std::size_t capacity = 1 << 20)
+        : fd(fd), buf(new char[capacity < 64 ? 64 : capacity]), cap(capacity < 64 ? 64 : capacity), len(0) {}
+
+    ~bulk_writer()
+    {
+        try{
+            flush();
+        }catch(...){}
+    }
+
+    void write(const char* s, std::size_t n)
+    {
+        if(cap-len<n){
+            flush();
+            if(cap<n){      // bigger than the whole buffer: straight through
+                write_all(s,n);
+                return;
+            }
+        }
+        std::memcpy(buf.get()+len,s,n);
+        len += n;
+    }
+
+    bulk_writer& operator<<(char c)
+    {
+        if(len==cap) flush();
+        buf[len++] = c;
+        return *this;
+    }
+
+    bulk_writer& operator<<(signed char c) { return *this << char(c); }
+    bulk_writer& operator<<(unsigned char c) { return *this << char(c); }
+    bulk_writer& operator<<(const char* s) { write(s,std::strlen(s)); return *this; }
+    bulk_writer& operator<<(const std::string& s) { write(s.data(),s.size()); return *this; }
+
+    template<class T>
+    bulk_writer& operator<<(const T& v)
+    {
+        put(v,typename kind<T>::type());
+        return *this;
+    }
+
+    void flush()
+    {
+        std::size_t n = len;
+        len = 0;
+        write_all(buf.get(),n);
+    }
+
+private:
+    struct integer_tag {};
+    struct floating_tag {};
+    struct other_tag {};
+
+    template<class T>
+    struct kind {
+        typedef typename std::conditional<std::is_integral<T>::value && !std::is_same<T,bool>::value, integer_tag,
+                typename std::conditional<std::is_floating_point<T>::value, floating_tag, other_tag>::type>::type type;
+    };
+
+    template<class T>
+    void put(T v, integer_tag)
+    {
+        typedef typename std::make_unsigned<T>::type U;
+        reserve(24);
+        U u = U(v);
+        if(v<0){
+            buf[len++] = '-';
+            u = U(0)-u;
+        }
+        char tmp[24];
+        char* p = tmp+sizeof(tmp);
+        static const char pairs[] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        while(100<=u){
+            unsigned d = unsigned(u%100)*2;
+            u /= 100;
+            *--p = pairs[d+1];
+            *--p = pairs[d];
+        }
+        if(10<=u){
+            *--p = pairs[2*u+1];
+            *--p = pairs[2*u];
+        }
+        else *--p = char('0'+u);
+        std::size_t n = tmp+sizeof(tmp)-p;
+        std::memcpy(buf.get()+len,p,n);
+        len += n;
+    }
+
+    void put(double v, floating_tag) { reserve(32); len += std::snprintf(buf.get()+len,32,"%g",v); }
+    void put(float v, floating_tag) { put(double(v),floating_tag()); }
+    void put(long double v, floating_tag) { reserve(48); len += std::snprintf(buf.get()+len,48,"%Lg",v); }
+
+    void put(bool v, other_tag) { *this << char('0'+v); }
+
+    template<class T>
+    void put(const T& v, other_tag)     // anything else with an operator<<, the slow way
+    {
+        std::ostringstream s;
+        s << v;
+        *this << s.str();
+    }
+
+    void reserve(std::size_t n) { if(cap-len<n) flush(); }
+
+    void write_all(const char* p, std::size_t n)
+    {
+        while(n){
+            ssize_t r = ::write(fd,p,n);
+            if(r<0){
+                if(errno==EINTR) continue;
+                throw std::system_error(errno,std::generic_category(),"bulk_writer");
+            }
+            p += r;
+            n -= std::size_t(r);
+        }
+    }
+
+    int fd;
+    std::unique_ptr<char[]> buf;
+    std::size_t cap;
+    std::size_t len;
+
+    bulk_writer(const bulk_writer&);
+    bulk_writer& operator=(const bulk_writer&);
+};
+
+// one writer over stdout, so its buffer is reused from call to call
+inline bulk_writer& stdout_writer()
+{
+    static bulk_writer w(1);
+    return w;
+}
+
+#endif // BULK_WRITER_H
@@ -0,0 +1,166 @@
+#ifndef CHECKED_RANGE_H
+#define CHECKED_RANGE_H
+
+#include <algorithm>
+#include <numeric>
+#include "vector.h"
+#include "string_sort.h"
+#include "simd_kernels.h"
+
+// a [first,last) pair of checked iterators validated once against their vector;
+// algorithms taking a checked_range then run on plain pointers, so the safety
+// check is paid at the call, not on every ++ and * inside the loop
+template<class Iter>    // vector<T,A,C,G>::checked_iterator or const_checked_iterator
+class checked_range {
+public:
+    typedef typename Iter::container_type           container_type;
+    typedef typename Iter::value_type               value_type;
+    typedef decltype(std::declval<Iter>().plain_iterator()) pointer;   // T* or const T*
+    typedef typename container_type::check_policy   check_policy;
+
+    checked_range(const Iter& f, const Iter& l) throw(iterator_range_error)
+        : vec_obj(f.container()), first(f.plain_iterator()), last(l.plain_iterator())
+    {
+        check_policy::check(vec_obj!=0 && vec_obj==l.container(),"checked_range"," spans two vectors");
+        check_policy::check(f.generation()==vec_obj->generation() && l.generation()==vec_obj->generation(),
+                            "checked_range"," holds an iterator its vector has reallocated under");
+        check_policy::check(vec_obj->begin()<=first,"checked_range"," starts before begin()",
+                            first-vec_obj->begin(),last-first);
+        check_policy::check(first<=last,"checked_range"," ends before it starts",
+                            first-vec_obj->begin(),last-first);
+        check_policy::check(last<=vec_obj->end(),"checked_range"," passed end()",
+                            first-vec_obj->begin(),last-first);
+    }
+
+    pointer begin() const { return first; }
+    pointer end() const { return last; }
+    int size() const { return last-first; }
+
+    // back to a checked iterator, for handing results to the caller
+    Iter checked(pointer p) const { return Iter(vec_obj,p); }
+
+private:
+    const container_type* vec_obj;
+    pointer first;
+    pointer last;
+};
+
+template<class Iter>
+checked_range<Iter> make_checked_range(const Iter& first, const Iter& last) throw(iterator_range_error)
+{
+    return checked_range<Iter>(first,last);
+}
+
+template<class T, class A, class C, class G>
+checked_range<typename vector<T,A,C,G>::checked_iterator> make_checked_range(vector<T,A,C,G>& v)
+{
+    return checked_range<typename vector<T,A,C,G>::checked_iterator>(v.checked_begin(),v.checked_end());
+}
+
+// for algorithms that take either kind of iterator pair: plain iterators are
+// passed through, checked_iterators are validated once as a checked_range
+// and the algorithm walks the pointers underneath. result() maps a pointer
+// back to the caller's iterator type
+namespace range_detail {
+
+template<class It, class = void>
+struct is_checked : std::false_type {};
+
+template<class It>
+struct is_checked<It, decltype((void)std::declval<It>().container())> : std::true_type {};
+
+template<class It>
+struct raw_range {
+    It first, last;
+    raw_range(It f, It l) : first(f), last(l) {}
+    It result(It p) const { return p; }
+};
+
+template<class It>
+struct checked_raw_range {
+    checked_range<It> r;
+    typename checked_range<It>::pointer first, last;
+    checked_raw_range(It f, It l) : r(f,l), first(r.begin()), last(r.end()) {}
+    It result(typename checked_range<It>::pointer p) const { return r.checked(p); }
+};
+
+template<class It>
+raw_range<It> unwrap(It f, It l, std::false_type) { return raw_range<It>(f,l); }
+
+template<class It>
+checked_raw_range<It> unwrap(It f, It l, std::true_type) { return checked_raw_range<It>(f,l); }
+
+template<class It>
+auto unwrap(It f, It l) -> decltype(unwrap(f,l,is_checked<It>()))
+{
+    return unwrap(f,l,is_checked<It>());
+}
+
+}   // namespace range_detail
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// algorithms over checked ranges
+
+template<class Iter>
+void sort(checked_range<Iter> r)    // string_sort when the elements are std::string
+{
+    string_sort_detail::default_sort(r.begin(),r.end());
+}
+
+template<class Iter, class Compare>
+void sort(checked_range<Iter> r, Compare comp)
+{
+    std::sort(r.begin(),r.end(),comp);
+}
+
+template<class Iter, class U>
+Iter find(checked_range<Iter> r, const U& val)     // vectorized for int, float and double
+{
+    const typename Iter::value_type* f = r.begin();
+    return r.checked(r.begin()+(simd_detail::find(f,f+r.size(),val)-f));
+}
+
+template<class Iter, class Out>
+Out copy(checked_range<Iter> r, Out out)
+{
+    return std::copy(r.begin(),r.end(),out);
+}
+
+// copying into another checked range checks the destination size once, up front
+template<class Iter, class Iter2>
+Iter2 copy(checked_range<Iter> r, checked_range<Iter2> out) throw(iterator_range_error)
+{
+    typedef typename checked_range<Iter2>::check_policy C;
+    C::check(r.size()<=out.size(),"copy(checked_range, checked_range)"," destination too small",
+             out.size(),r.size());
+    return out.checked(std::copy(r.begin(),r.end(),out.begin()));
+}
+
+template<class Iter, class Out, class F>
+Out transform(checked_range<Iter> r, Out out, F f)
+{
+    return std::transform(r.begin(),r.end(),out,f);
+}
+
+template<class Iter, class Iter2, class F>
+Iter2 transform(checked_range<Iter> r, checked_range<Iter2> out, F f) throw(iterator_range_error)
+{
+    typedef typename checked_range<Iter2>::check_policy C;
+    C::check(r.size()<=out.size(),"transform(checked_range, checked_range)"," destination too small",
+             out.size(),r.size());
+    return out.checked(std::transform(r.begin(),r.end(),out.begin(),f));
+}
+
+template<class Iter, class U>
+U accumulate(checked_range<Iter> r, U init)
+{
+    return std::accumulate(r.begin(),r.end(),init);
+}
+
+template<class Iter, class U, class F>
+U accumulate(checked_range<Iter> r, U init, F f)
+{
+    return std::accumulate(r.begin(),r.end(),init,f);
+}
+
+#endif // CHECKED_RANGE_H
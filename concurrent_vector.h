@@ -0,0 +1,372 @@
+#ifndef CONCURRENT_VECTOR_H
+#define CONCURRENT_VECTOR_H
+
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include "vector.h"
+
+// an append-only vector many threads can push_back into at once. the elements
+// live in segments that double in size and never move, so a reference or an
+// index stays good while others append. push_back claims its slot with one
+// fetch_add, constructs the element there and marks it ready; size() is the
+// prefix of slots that are all settled, so a reader iterating [0,size()) only
+// sees whole elements, and never waits for a writer. clear() and destruction
+// are not concurrent. if T's constructor throws or a segment can't be
+// allocated, push_back waits for the slots before its own to settle, steps
+// size() over its slot and rethrows. the slot is left a hole, holding no
+// element: is_hole(i) tells, at() and the checked iterators throw on it, and
+// the elements after it stay visible. (so an element's constructor must not
+// push_back into the vector it is being built in)
+
+namespace concurrent_detail {
+
+const int first_segment = 64;   // elements in segment 0; segment s holds first_segment<<s
+const int max_segments = 25;    // the last one ends below INT_MAX, so every segment size and bound is an int
+const int max_size = first_segment*((1<<max_segments)-1);  // segment_base(max_segments)
+
+// the segment holding index i, and where in it
+inline int segment_of(int i)
+{
+    return 31-__builtin_clz(unsigned(i/first_segment+1));
+}
+
+inline int segment_base(int s) { return first_segment*((1<<s)-1); }
+inline int segment_size(int s) { return first_segment<<s; }
+
+}   // namespace concurrent_detail
+
+// random access over the indices of V, the same walk as soa_iterator. the
+// bounds are V's size() at the time of the check, which only ever grows
+template<class V, class T, class Check>
+class concurrent_iterator {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_const<T>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    concurrent_iterator() : vec_obj(0), i(0) {}
+    concurrent_iterator(V* v, int index) throw(iterator_range_error) : vec_obj(v), i(index)
+    {
+        check_position(i,"concurrent_iterator(V*, int)");
+    }
+
+    template<class V2, class T2, class Check2,
+             class = typename std::enable_if<std::is_convertible<V2*,V*>::value>::type>
+    concurrent_iterator(const concurrent_iterator<V2,T2,Check2>& p) : vec_obj(p.container()), i(p.index()) {}
+
+    T& operator*() const throw(iterator_range_error)
+    {
+        Check::check(0<=i && i<vec_obj->size() && !vec_obj->is_hole(i),"concurrent_iterator::operator*()"," not dereferenceable",i);
+        return (*vec_obj)[i];
+    }
+
+    T* operator->() const throw(iterator_range_error) { return &**this; }
+
+    T& operator[](difference_type k) const throw(iterator_range_error)
+    {
+        Check::check(0<=i+k && i+k<vec_obj->size() && !vec_obj->is_hole(int(i+k)),"concurrent_iterator::operator[]"," not dereferenceable",i,k);
+        return (*vec_obj)[int(i+k)];
+    }
+
+    concurrent_iterator& operator++() throw(iterator_range_error) { return *this += 1; }
+    concurrent_iterator& operator--() throw(iterator_range_error) { return *this -= 1; }
+    concurrent_iterator operator++(int) throw(iterator_range_error) { concurrent_iterator t(*this); *this += 1; return t; }
+    concurrent_iterator operator--(int) throw(iterator_range_error) { concurrent_iterator t(*this); *this -= 1; return t; }
+
+    concurrent_iterator& operator+=(difference_type k) throw(iterator_range_error)
+    {
+        check_position(i+k,"concurrent_iterator::operator+=(difference_type)",k);
+        i += int(k);
+        return *this;
+    }
+
+    concurrent_iterator& operator-=(difference_type k) throw(iterator_range_error) { return *this += -k; }
+    concurrent_iterator operator+(difference_type k) const throw(iterator_range_error) { concurrent_iterator t(*this); return t += k; }
+    concurrent_iterator operator-(difference_type k) const throw(iterator_range_error) { concurrent_iterator t(*this); return t += -k; }
+
+    template<class V2, class T2, class C2>
+    difference_type operator-(const concurrent_iterator<V2,T2,C2>& p) const { return i-p.index(); }
+
+    template<class V2, class T2, class C2>
+    bool operator==(const concurrent_iterator<V2,T2,C2>& p) const { return i==p.index() && vec_obj==p.container(); }
+    template<class V2, class T2, class C2>
+    bool operator!=(const concurrent_iterator<V2,T2,C2>& p) const { return !(*this==p); }
+    template<class V2, class T2, class C2>
+    bool operator<(const concurrent_iterator<V2,T2,C2>& p) const { return i<p.index(); }
+    template<class V2, class T2, class C2>
+    bool operator>(const concurrent_iterator<V2,T2,C2>& p) const { return i>p.index(); }
+    template<class V2, class T2, class C2>
+    bool operator<=(const concurrent_iterator<V2,T2,C2>& p) const { return i<=p.index(); }
+    template<class V2, class T2, class C2>
+    bool operator>=(const concurrent_iterator<V2,T2,C2>& p) const { return i>=p.index(); }
+
+    int index() const { return i; }
+    V* container() const { return vec_obj; }
+
+private:
+    void check_position(difference_type p, const char* s, difference_type offset = 0) const throw(iterator_range_error)
+    {
+        Check::check(p<=vec_obj->size(),s," passed end()",p-offset,offset);
+        Check::check(0<=p,s," before begin()",p-offset,offset);
+    }
+
+    V* vec_obj;
+    int i;
+};
+
+template<class T, class A = std::allocator<T>, class C = VECTOR_CHECK_POLICY>
+class concurrent_vector {
+    typedef std::allocator_traits<A> alloc_traits;
+
+    struct segment {
+        T* elem;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef C check_policy;
+    typedef concurrent_iterator<concurrent_vector,T,unchecked> iterator;
+    typedef concurrent_iterator<const concurrent_vector,const T,unchecked> const_iterator;
+    typedef concurrent_iterator<concurrent_vector,T,C> checked_iterator;
+    typedef concurrent_iterator<const concurrent_vector,const T,C> const_checked_iterator;
+
+    explicit concurrent_vector(const A& a = A()) : alloc(a), claimed(0), committed(0)
+    {
+        for(int s=0 ; s<concurrent_detail::max_segments ; ++s) table[s].store(0,std::memory_order_relaxed);
+    }
+
+    ~concurrent_vector() { destroy_all(); }
+
+    // all of these may run at the same time as each other and as the readers;
+    // they return the new element's index
+    int push_back(const T& val) { return emplace_back(val); }
+    int push_back(T&& val) { return emplace_back(std::move(val)); }
+
+    template<class... Args>
+    int emplace_back(Args&&... args);
+
+    // n copies of val at consecutive indices; the first is returned
+    int grow_by(int n, const T& val = T());
+
+    // the slots every push_back so far has settled: [0,size()) is safe to read,
+    // apart from the holes a push_back that threw left behind
+    int size() const { return committed.load(std::memory_order_acquire); }
+    bool is_hole(int i) const { return !is_ready(i); }
+    bool empty() const { return size()==0; }
+    int capacity() const;
+    static int max_size() { return concurrent_detail::max_size; }
+
+    // segments for n elements up front; safe alongside push_back
+    void reserve(int n);
+
+    T& operator[](int i) { return slot(i); }
+    const T& operator[](int i) const { return slot(i); }
+
+    T& at(int n)
+    {
+        if(n<0 || size()<=n || is_hole(n)) throw Range_error(n);
+        return slot(n);
+    }
+
+    const T& at(int n) const
+    {
+        if(n<0 || size()<=n || is_hole(n)) throw Range_error(n);
+        return slot(n);
+    }
+
+    // end() is size() when it is called: a loop testing it != end() also
+    // walks the elements appended meanwhile
+    iterator begin() { return iterator(this,0); }
+    iterator end() { return iterator(this,size()); }
+    const_iterator begin() const { return const_iterator(this,0); }
+    const_iterator end() const { return const_iterator(this,size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    checked_iterator checked_begin() { return checked_iterator(this,0); }
+    checked_iterator checked_end() { return checked_iterator(this,size()); }
+    const_checked_iterator checked_cbegin() const { return const_checked_iterator(this,0); }
+    const_checked_iterator checked_cend() const { return const_checked_iterator(this,size()); }
+
+    // not concurrent: no push_back may be running
+    void clear();
+
+private:
+    T& slot(int i) const
+    {
+        int s = concurrent_detail::segment_of(i);
+        return table[s].load(std::memory_order_acquire)->elem[i-concurrent_detail::segment_base(s)];
+    }
+
+    segment* get_segment(int s);
+    void publish(int i);
+    void skip(int first, int n);
+    void advance(int c);
+
+    bool is_ready(int i) const;
+    void destroy_all();
+
+    A alloc;
+    std::atomic<int> claimed;      // slots handed out
+    std::atomic<int> committed;    // every slot below this is constructed or a hole
+    std::atomic<segment*> table[concurrent_detail::max_segments];
+
+    concurrent_vector(const concurrent_vector&);
+    concurrent_vector& operator=(const concurrent_vector&);
+};
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// growth
+
+template<class T, class A, class C>
+template<class... Args>
+int concurrent_vector<T,A,C>::emplace_back(Args&&... args)
+{
+    int i = claimed.fetch_add(1,std::memory_order_relaxed);
+    if(i<0 || concurrent_detail::max_size<=i) throw std::length_error("concurrent_vector: more than max_size() elements");
+    try{
+        get_segment(concurrent_detail::segment_of(i));
+        alloc_traits::construct(alloc,&slot(i),std::forward<Args>(args)...);
+    }catch(...){
+        skip(i,1);
+        throw;
+    }
+    publish(i);
+    return i;
+}
+
+template<class T, class A, class C>
+int concurrent_vector<T,A,C>::grow_by(int n, const T& val)
+{
+    if(n<=0) return claimed.load(std::memory_order_relaxed);
+    int first = claimed.fetch_add(n,std::memory_order_relaxed);
+    if(first<0 || concurrent_detail::max_size-n<first) throw std::length_error("concurrent_vector: more than max_size() elements");
+    int i = first;
+    try{
+        for(int s=concurrent_detail::segment_of(first) ; s<=concurrent_detail::segment_of(first+n-1) ; ++s) get_segment(s);
+        for( ; i<first+n ; ++i){
+            alloc_traits::construct(alloc,&slot(i),val);
+            publish(i);
+        }
+    }catch(...){
+        skip(i,first+n-i);
+        throw;
+    }
+    return first;
+}
+
+// segment s, allocated by whichever thread gets there first
+template<class T, class A, class C>
+typename concurrent_vector<T,A,C>::segment* concurrent_vector<T,A,C>::get_segment(int s)
+{
+    segment* seg = table[s].load(std::memory_order_acquire);
+    if(seg) return seg;
+    int n = concurrent_detail::segment_size(s);
+    std::unique_ptr<segment> fresh(new segment);
+    fresh->ready.reset(new std::atomic<bool>[n]());
+    fresh->elem = alloc_traits::allocate(alloc,n);
+    if(table[s].compare_exchange_strong(seg,fresh.get(),std::memory_order_acq_rel,std::memory_order_acquire))
+        return fresh.release();
+    alloc_traits::deallocate(alloc,fresh->elem,n);   // lost the race: seg is the winner's
+    return seg;
+}
+
+template<class T, class A, class C>
+bool concurrent_vector<T,A,C>::is_ready(int i) const
+{
+    if(concurrent_detail::max_size<=i) return false;
+    int s = concurrent_detail::segment_of(i);
+    segment* seg = table[s].load(std::memory_order_acquire);
+    return seg && seg->ready[i-concurrent_detail::segment_base(s)].load();
+}
+
+// marks slot i ready, then moves committed past it and over every ready slot
+// after it. when i isn't next in line, whoever gets committed up to it will
+// see it ready. no slot is left behind: either this thread sees committed
+// reach i, or the thread that moved it there sees slot i ready
+template<class T, class A, class C>
+void concurrent_vector<T,A,C>::publish(int i)
+{
+    int s = concurrent_detail::segment_of(i);
+    table[s].load(std::memory_order_relaxed)->ready[i-concurrent_detail::segment_base(s)].store(true);
+    int c = i;
+    if(committed.compare_exchange_strong(c,i+1)) c = i+1;     // in order, the usual case
+    advance(c);
+}
+
+// slots [first,first+n) will never hold elements. a hole is never ready, so
+// nobody else moves committed over it: once the slots before it have settled
+// committed stops at first, and this thread steps it over the holes
+template<class T, class A, class C>
+void concurrent_vector<T,A,C>::skip(int first, int n)
+{
+    while(committed.load()!=first) std::this_thread::yield();
+    committed.store(first+n);
+    advance(first+n);
+}
+
+template<class T, class A, class C>
+void concurrent_vector<T,A,C>::advance(int c)
+{
+    while(c<claimed.load(std::memory_order_relaxed) && is_ready(c))
+        if(committed.compare_exchange_weak(c,c+1)) ++c;
+}
+
+template<class T, class A, class C>
+int concurrent_vector<T,A,C>::capacity() const
+{
+    int s = 0;
+    while(s<concurrent_detail::max_segments && table[s].load(std::memory_order_acquire)) ++s;
+    return concurrent_detail::segment_base(s);
+}
+
+template<class T, class A, class C>
+void concurrent_vector<T,A,C>::reserve(int n)
+{
+    if(n<=0) return;
+    if(concurrent_detail::max_size<n) throw std::length_error("concurrent_vector: reserve past max_size()");
+    for(int s=0 ; s<=concurrent_detail::segment_of(n-1) ; ++s) get_segment(s);
+}
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// teardown
+
+template<class T, class A, class C>
+void concurrent_vector<T,A,C>::clear()
+{
+    int n = claimed.load();
+    for(int i=0 ; i<n ; ++i){
+        if(!is_ready(i)) continue;      // a hole
+        int s = concurrent_detail::segment_of(i);
+        segment* seg = table[s].load();
+        alloc_traits::destroy(alloc,seg->elem+(i-concurrent_detail::segment_base(s)));
+        seg->ready[i-concurrent_detail::segment_base(s)].store(false);
+    }
+    committed.store(0);
+    claimed.store(0);
+}
+
+template<class T, class A, class C>
+void concurrent_vector<T,A,C>::destroy_all()
+{
+    clear();
+    for(int s=0 ; s<concurrent_detail::max_segments ; ++s){
+        segment* seg = table[s].load();
+        if(!seg) break;
+        alloc_traits::deallocate(alloc,seg->elem,concurrent_detail::segment_size(s));
+        delete seg;
+        table[s].store(0);
+    }
+}
+
+#endif // CONCURRENT_VECTOR_H
@@ -0,0 +1,177 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <istream>
+#include <string>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <system_error>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "vector.h"
+
+// whitespace separated tokens straight into a vector<std::string>: big blocks
+// are read with read(2) or streambuf::sgetn, split 64 bytes at a time on a
+// whitespace bitmask, and every token is emplaced from the block, with no
+// operator>>, no locale and no temporary string. whitespace is what >> skips
+// in the C locale: space, \t \n \v \f \r
+
+namespace ingest_detail {
+
+const std::size_t block_size = 1 << 20;
+
+inline bool is_space(unsigned char c) { return c==' ' || unsigned(c-'\t')<5; }
+
+// bit i set when p[i] is whitespace
+inline std::uint64_t whitespace_mask(const char* p)
+{
+#ifdef __SSE2__
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i four = _mm_set1_epi8(4);
+    std::uint64_t m = 0;
+    for(int i=0 ; i<4 ; ++i){
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p+16*i));
+        __m128i c = _mm_sub_epi8(b,tab);                            // \t..\r -> 0..4
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(b,space),_mm_cmpeq_epi8(_mm_min_epu8(c,four),c));
+        m |= std::uint64_t(unsigned(_mm_movemask_epi8(ws))) << (16*i);
+    }
+    return m;
+#else
+    std::uint64_t m = 0;
+    for(int i=0 ; i<64 ; ++i) m |= std::uint64_t(is_space(p[i])) << i;
+    return m;
+#endif
+}
+
+// calls emit(b,e) for every token that ends inside [p,end); a token still
+// open at end is left for the next block. returns where it starts (or end)
+template<class Emit>
+const char* split(const char* p, const char* end, const char* start, bool in_token, Emit& emit)
+{
+    for( ; 64<=end-p ; p+=64){
+        std::uint64_t ws = whitespace_mask(p);
+        std::uint64_t rest = ~std::uint64_t(0);     // bits not looked at yet
+        for(;;){
+            std::uint64_t m = (in_token ? ws : ~ws) & rest;
+            if(!m) break;
+            int i = __builtin_ctzll(m);
+            if(in_token) emit(start,p+i);
+            else start = p+i;
+            in_token = !in_token;
+            rest = ~std::uint64_t(0) << i;
+        }
+    }
+    for( ; p!=end ; ++p){
+        if(is_space(*p)){
+            if(in_token) emit(start,p);
+            in_token = false;
+        }
+        else if(!in_token){
+            start = p;
+            in_token = true;
+        }
+    }
+    return in_token ? start : end;
+}
+
+// the reading loop: fill(buf,n) returns the bytes read, 0 at end of input
+template<class Fill, class Emit>
+void read_blocks(Fill fill, Emit emit)
+{
+    std::size_t cap = block_size;
+    std::unique_ptr<char[]> buf(new char[cap]);
+    std::size_t carry = 0;      // an unfinished token, moved to the front of buf
+    for(;;){
+        if(carry==cap){         // a token longer than the whole buffer
+            std::unique_ptr<char[]> bigger(new char[2*cap]);
+            std::memcpy(bigger.get(),buf.get(),carry);
+            buf.swap(bigger);
+            cap *= 2;
+        }
+        std::size_t got = fill(buf.get()+carry,cap-carry);
+        char* end = buf.get()+carry+got;
+        if(got==0){
+            if(carry) emit(buf.get(),end);
+            return;
+        }
+        const char* open = split(buf.get()+carry,end,buf.get(),carry!=0,emit);
+        carry = end-open;
+        std::memmove(buf.get(),open,carry);
+    }
+}
+
+// room for the tokens still to come from bytes of input, on top of what v
+// holds. the guess is low on purpose, one token per 16 bytes: the slots then
+// take at most twice the input, whatever the token length, and a file of
+// short words grows past it once or twice. past max_guess tokens growth takes
+// over, so a sparse file or a stream lying about its end can't reserve
+// gigabytes up front. the sum is kept in long long and clamped to what an
+// int size can still hold
+const long long max_guess = 1 << 24;
+
+template<class V>
+void reserve_tokens(V& v, long long bytes)
+{
+    if(bytes<=0) return;
+    long long want = (long long)v.size() + std::min(bytes/16,max_guess);
+    v.reserve(int(std::min(want,(long long)INT_MAX)));
+}
+
+template<class A, class C, class G>
+struct emplacer {
+    vector<std::string,A,C,G>* v;
+    void operator()(const char* b, const char* e) const { v->emplace_back(b,std::size_t(e-b)); }
+};
+
+}   // namespace ingest_detail
+
+// reads fd to its end and appends its tokens to v; returns how many were added
+template<class A, class C, class G>
+int read_tokens(int fd, vector<std::string,A,C,G>& v)
+{
+    using namespace ingest_detail;
+    struct stat st;
+    if(fstat(fd,&st)==0 && S_ISREG(st.st_mode)){
+        off_t pos = lseek(fd,0,SEEK_CUR);
+        if(0<=pos && pos<st.st_size) reserve_tokens(v,(long long)(st.st_size-pos));
+    }
+    int before = v.size();
+    emplacer<A,C,G> emit = { &v };
+    read_blocks([fd](char* p, std::size_t n) -> std::size_t {
+        for(;;){
+            ssize_t r = ::read(fd,p,n);
+            if(0<=r) return std::size_t(r);
+            if(errno!=EINTR) throw std::system_error(errno,std::generic_category(),"read_tokens");
+        }
+    },emit);
+    return v.size()-before;
+}
+
+// the same over an istream's buffer; the stream is left at eof
+template<class A, class C, class G>
+int ingest(std::istream& is, vector<std::string,A,C,G>& v)
+{
+    using namespace ingest_detail;
+    std::streambuf* sb = is.rdbuf();
+    std::streampos pos = sb->pubseekoff(0,std::ios::cur,std::ios::in);
+    if(pos!=std::streampos(-1)){
+        std::streampos last = sb->pubseekoff(0,std::ios::end,std::ios::in);
+        sb->pubseekpos(pos,std::ios::in);
+        if(pos<last) reserve_tokens(v,(long long)(last-pos));
+    }
+    int before = v.size();
+    emplacer<A,C,G> emit = { &v };
+    read_blocks([sb](char* p, std::size_t n) -> std::size_t { return std::size_t(sb->sgetn(p,std::streamsize(n))); },emit);
+    is.setstate(std::ios::eofbit);
+    return v.size()-before;
+}
+
+#endif // INGEST_H
@@ -0,0 +1,313 @@
+#ifndef MAPPED_VECTOR_H
+#define MAPPED_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "vector.h"
+
+// vectors that live in a file: the elements are the file's bytes, after a
+// 64 byte header. the block grows with ftruncate + mremap, so vector<T,A>
+// reaches it through A::reallocate like it does realloc (see allocators.h).
+// only for trivially copyable T: what is in the file must mean the same
+// thing to the next process that maps it
+
+// one file, mapped whole. it can hand out a single block, the data area
+class mapped_file {
+public:
+    struct header {
+        char magic[8];
+        std::uint32_t elem_size;
+        std::uint32_t elem_align;
+        std::uint64_t head;         // the vector's front gap, in elements
+        std::uint64_t size;
+        std::uint64_t capacity;     // from the end of the front gap
+        char reserved[24];
+    };
+    static const std::size_t header_size = 64;
+    static_assert(sizeof(header)==header_size,"the header is part of the file format");
+
+    mapped_file(const char* path, bool read_only)
+        : fd(-1), base(0), mapped(0), writable(!read_only), busy(false), fresh(false)
+    {
+        fd = ::open(path,read_only ? O_RDONLY : O_RDWR|O_CREAT,0644);
+        if(fd<0) fail("open");
+        try{
+            struct stat st;
+            if(fstat(fd,&st)!=0) fail("fstat");
+            std::size_t bytes = std::size_t(st.st_size);
+            if(bytes==0 && writable){   // a new file: a zeroed header
+                if(ftruncate(fd,header_size)!=0) fail("ftruncate");
+                bytes = header_size;
+                fresh = true;
+            }
+            if(bytes<header_size)
+                throw std::runtime_error(std::string("mapped_file: ")+path+" is too short for a header");
+            void* p = ::mmap(0,bytes,writable ? PROT_READ|PROT_WRITE : PROT_READ,MAP_SHARED,fd,0);
+            if(p==MAP_FAILED) fail("mmap");
+            base = static_cast<char*>(p);
+            mapped = bytes;
+        }catch(...){
+            ::close(fd);
+            throw;
+        }
+    }
+
+    ~mapped_file()
+    {
+        if(base) ::munmap(base,mapped);
+        if(0<=fd) ::close(fd);
+    }
+
+    // the file was empty when opened: its header is ours to write, while any
+    // other file's must be checked, never overwritten
+    bool is_new() const { return fresh; }
+
+    header& head() { return *reinterpret_cast<header*>(base); }
+    const header& head() const { return *reinterpret_cast<const header*>(base); }
+
+    char* data() { return base+header_size; }
+    const char* data() const { return base+header_size; }
+    std::size_t data_bytes() const { return mapped-header_size; }
+    bool owns(const void* p) const { return busy && p==data(); }
+
+    // the data area, resized to bytes; a second block must come from elsewhere
+    char* acquire(std::size_t bytes)
+    {
+        resize(bytes);
+        busy = true;
+        return data();
+    }
+
+    void release() { busy = false; }    // the bytes stay in the file
+    bool in_use() const { return busy; }
+
+    char* resize(std::size_t bytes)
+    {
+        std::size_t n = header_size+bytes;
+        if(n==mapped) return data();
+        // the file is never shorter than the mapping: pages past its end fault
+        if(mapped<n && ftruncate(fd,off_t(n))!=0) fail("ftruncate");
+        void* p = ::mremap(base,mapped,n,MREMAP_MAYMOVE);
+        if(p==MAP_FAILED) fail("mremap");
+        base = static_cast<char*>(p);
+        mapped = n;
+        if(ftruncate(fd,off_t(n))!=0) fail("ftruncate");
+        return data();
+    }
+
+    void sync()
+    {
+        if(writable && ::msync(base,mapped,MS_SYNC)!=0) fail("msync");
+    }
+
+private:
+    static void fail(const char* what)
+    {
+        throw std::system_error(errno,std::generic_category(),std::string("mapped_file: ")+what);
+    }
+
+    int fd;
+    char* base;
+    std::size_t mapped;
+    bool writable;
+    bool busy;
+    bool fresh;
+
+    mapped_file(const mapped_file&);
+    mapped_file& operator=(const mapped_file&);
+};
+
+// the file's data area for the first block, anonymous mappings for any other
+// (and for copies, which select_on_container_copy_construction keeps off the file)
+template<class T>
+class mapped_allocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U> struct rebind { typedef mapped_allocator<U> other; };
+
+    explicit mapped_allocator(mapped_file* f = 0) : file(f) {}
+    template<class U> mapped_allocator(const mapped_allocator<U>&) : file(0) {}
+
+    mapped_allocator select_on_container_copy_construction() const { return mapped_allocator(); }
+
+    T* allocate(size_type n)
+    {
+        if(n==0) return 0;
+        if(file && !file->in_use()) return reinterpret_cast<T*>(file->acquire(n*sizeof(T)));
+        void* p = ::mmap(0,n*sizeof(T),PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+        if(p==MAP_FAILED) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_type n)
+    {
+        if(!p) return;
+        if(file && file->owns(p)) file->release();
+        else ::munmap(p,n*sizeof(T));
+    }
+
+    // only valid for trivially relocatable T, like malloc_allocator's
+    T* reallocate(T* p, size_type old, size_type n)
+    {
+        if(file && file->owns(p)) return reinterpret_cast<T*>(file->resize(n*sizeof(T)));
+        void* q = ::mremap(p,old*sizeof(T),n*sizeof(T),MREMAP_MAYMOVE);
+        if(q==MAP_FAILED) throw std::bad_alloc();
+        return static_cast<T*>(q);
+    }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) { ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    template<class U>
+    void destroy(U* p) { p->~U(); }
+
+    mapped_file* file;
+};
+
+template<class T, class U>
+bool operator==(const mapped_allocator<T>& a, const mapped_allocator<U>& b) { return a.file==b.file; }
+
+template<class T, class U>
+bool operator!=(const mapped_allocator<T>& a, const mapped_allocator<U>& b) { return a.file!=b.file; }
+
+namespace mapped_detail {
+
+inline void check_header(const mapped_file& f, std::size_t size, std::size_t align, const char* path)
+{
+    const mapped_file::header& h = f.head();
+    if(std::memcmp(h.magic,"VECMAP01",8)!=0)
+        throw std::runtime_error(std::string("mapped_vector: ")+path+" is not a mapped_vector file");
+    if(h.elem_size!=size || h.elem_align!=align)
+        throw std::runtime_error(std::string("mapped_vector: ")+path+" holds elements of another type");
+    // the counts are checked before they are made ints or used to size anything
+    if(std::uint64_t(INT_MAX)<h.head || std::uint64_t(INT_MAX)-h.head<h.capacity)
+        throw std::runtime_error(std::string("mapped_vector: ")+path+" holds more elements than a vector can");
+    if(h.capacity<h.size)
+        throw std::runtime_error(std::string("mapped_vector: ")+path+" has more elements than capacity");
+    if(f.data_bytes()/size<h.head+h.capacity)
+        throw std::runtime_error(std::string("mapped_vector: ")+path+" is truncated");
+}
+
+class file_holder {     // a base, so the file is mapped before the vector and unmapped after it
+protected:
+    explicit file_holder(mapped_file* f) : file(f) {}
+    std::unique_ptr<mapped_file> file;
+};
+
+}   // namespace mapped_detail
+
+// vector<T> over a file: opening a new (missing or empty) file gives an empty
+// vector, opening one it wrote before gives back its elements without reading
+// them, and any other file is refused untouched. the header is written on
+// sync() and when the mapped_vector goes away
+template<class T, class C = VECTOR_CHECK_POLICY, class G = double_growth<> >
+class mapped_vector : private mapped_detail::file_holder, public vector<T,mapped_allocator<T>,C,G> {
+    static_assert(std::is_trivially_copyable<T>::value,"mapped_vector stores raw bytes");
+    static_assert(alignof(T)<=mapped_file::header_size,"elements would be misaligned after the header");
+    typedef vector<T,mapped_allocator<T>,C,G> base;
+
+public:
+    explicit mapped_vector(const char* path)
+        : file_holder(new mapped_file(path,false)), base(mapped_allocator<T>(file.get()))
+    {
+        mapped_file::header& h = file->head();
+        if(file->is_new()){     // only an empty file is taken for a new one
+            std::memcpy(h.magic,"VECMAP01",8);
+            h.elem_size = sizeof(T);
+            h.elem_align = alignof(T);
+            return;
+        }
+        mapped_detail::check_header(*file,sizeof(T),alignof(T),path);
+        if(h.head+h.capacity==0) return;
+        T* block = reinterpret_cast<T*>(file->acquire((h.head+h.capacity)*sizeof(T)));
+        this->adopt(block,int(h.head),int(h.size),int(h.capacity));
+    }
+
+    mapped_vector(mapped_vector&& v) : file_holder(v.file.release()), base(std::move(v)) {}
+
+    ~mapped_vector()
+    {
+        if(!file) return;   // moved from
+        try{
+            sync();
+        }catch(...){}
+    }
+
+    // header and elements to disk
+    void sync()
+    {
+        write_header();
+        file->sync();
+    }
+
+private:
+    void write_header()
+    {
+        mapped_file::header& h = file->head();
+        bool in_file = this->size()+this->capacity()!=0 && file->owns(this->begin()-this->front_capacity());
+        h.head = in_file ? this->front_capacity() : 0;
+        h.size = in_file ? this->size() : 0;
+        h.capacity = in_file ? this->capacity() : 0;
+    }
+
+    mapped_vector(const mapped_vector&);
+    mapped_vector& operator=(const mapped_vector&);
+    mapped_vector& operator=(mapped_vector&&);
+};
+
+// a file written by mapped_vector<T>, mapped read only: begin() points into
+// the page cache, nothing is parsed or copied
+template<class T>
+class mapped_view {
+    static_assert(std::is_trivially_copyable<T>::value,"mapped_view reads raw bytes");
+
+public:
+    typedef T value_type;
+    typedef const T* iterator;
+    typedef const T* const_iterator;
+
+    explicit mapped_view(const char* path) : file(path,true)
+    {
+        mapped_detail::check_header(file,sizeof(T),alignof(T),path);
+        const mapped_file::header& h = file.head();
+        first = reinterpret_cast<const T*>(file.data())+h.head;
+        sz = int(h.size);
+    }
+
+    const T& at(int n) const
+    {
+        if(n<0 || sz<=n) throw Range_error(n);
+        return first[n];
+    }
+    const T& operator[](int i) const { return first[i]; }
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first+sz; }
+    int size() const { return sz; }
+
+private:
+    mapped_file file;
+    const T* first;
+    int sz;
+};
+
+#endif // MAPPED_VECTOR_H
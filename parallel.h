@@ -0,0 +1,349 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "vector.h"
+#include "checked_range.h"
+#include "string_sort.h"
+
+// work-stealing pool: every worker owns a deque, pushes and pops its own
+// work at the back and, when it runs dry, steals from the front of the
+// others. whoever waits on a task_group runs queued tasks meanwhile, so
+// nested parallel calls can't deadlock the pool
+class thread_pool {
+public:
+    explicit thread_pool(unsigned n = std::thread::hardware_concurrency())
+        : done(false), queued(0), next_queue(0)
+    {
+        if(n==0) n = 1;
+        for(unsigned i=0 ; i<n ; ++i) queues.push_back(std::unique_ptr<work_queue>(new work_queue));
+        for(unsigned i=0 ; i<n ; ++i) threads.push_back(std::thread(&thread_pool::work,this,int(i)));
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            done = true;
+        }
+        wake.notify_all();
+        for(std::size_t i=0 ; i<threads.size() ; ++i) threads[i].join();
+    }
+
+    unsigned size() const { return unsigned(threads.size()); }
+
+    void submit(std::function<void()> f)
+    {
+        int q = owner()==this ? worker_index() : int(next_queue++ % queues.size());
+        {
+            std::lock_guard<std::mutex> lock(queues[q]->m);
+            queues[q]->tasks.push_back(std::move(f));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            ++queued;
+        }
+        wake.notify_one();
+    }
+
+    // run one queued task on the calling thread; false when there was none
+    bool run_one()
+    {
+        std::function<void()> f;
+        if(!grab(owner()==this ? worker_index() : 0,f)) return false;
+        f();
+        return true;
+    }
+
+    static thread_pool& default_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+private:
+    struct work_queue {
+        std::mutex m;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    static thread_pool*& owner() { static thread_local thread_pool* p = 0; return p; }
+    static int& worker_index() { static thread_local int i = 0; return i; }
+
+    bool grab(int self, std::function<void()>& f)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queues[self]->m);   // own work, newest first
+            if(!queues[self]->tasks.empty()){
+                f = std::move(queues[self]->tasks.back());
+                queues[self]->tasks.pop_back();
+                return taken();
+            }
+        }
+        for(std::size_t k=1 ; k<queues.size() ; ++k){          // steal, oldest (biggest) first
+            work_queue& q = *queues[(self+k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.m);
+            if(!q.tasks.empty()){
+                f = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return taken();
+            }
+        }
+        return false;
+    }
+
+    bool taken()
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        --queued;
+        return true;
+    }
+
+    void work(int self)
+    {
+        owner() = this;
+        worker_index() = self;
+        for(;;){
+            std::function<void()> f;
+            if(grab(self,f)){
+                f();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock,[this]{ return done || queued>0; });
+            if(done && queued==0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<work_queue> > queues;
+    std::vector<std::thread> threads;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool done;
+    long queued;
+    std::atomic<unsigned> next_queue;
+};
+
+// fork/join on a pool; the first exception thrown by a task comes out of wait()
+class task_group {
+public:
+    explicit task_group(thread_pool& p) : pool(p), left(0) {}
+    ~task_group() { wait_quietly(); }
+
+    template<class F>
+    void run(F f)
+    {
+        ++left;
+        pool.submit([this,f]{
+            try{
+                f();
+            }catch(...){
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error) error = std::current_exception();
+            }
+            --left;
+        });
+    }
+
+    void wait()
+    {
+        wait_quietly();
+        if(error) std::rethrow_exception(error);
+    }
+
+private:
+    void wait_quietly()
+    {
+        while(left>0)
+            if(!pool.run_one()) std::this_thread::yield();
+    }
+
+    thread_pool& pool;
+    std::atomic<int> left;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    task_group(const task_group&);
+    task_group& operator=(const task_group&);
+};
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+// parallel algorithms over contiguous ranges. ranges of checked_iterators are
+// validated once, as a checked_range, and then split into raw pointer chunks
+
+namespace parallel_detail {
+
+// elements per task: about what fits an L2 slice, so a chunk stays in cache
+template<class T>
+std::ptrdiff_t chunk_size()
+{
+    std::ptrdiff_t n = std::ptrdiff_t(256*1024/sizeof(T));
+    return n<1024 ? 1024 : n;
+}
+
+// call f(begin, end, chunk index) for each chunk, in parallel
+template<class P, class F>
+void for_chunks(P first, P last, std::ptrdiff_t chunk, thread_pool& pool, F f)
+{
+    std::ptrdiff_t n = last-first;
+    if(n<=chunk || pool.size()==1){
+        for(std::ptrdiff_t i=0, k=0 ; i<n ; i+=chunk, ++k) f(first+i,first+std::min(n,i+chunk),k);
+        return;
+    }
+    task_group g(pool);
+    for(std::ptrdiff_t i=0, k=0 ; i<n ; i+=chunk, ++k){
+        P b = first+i;
+        P e = first+std::min(n,i+chunk);
+        g.run([=,&f]{ f(b,e,k); });
+    }
+    g.wait();
+}
+
+}   // namespace parallel_detail
+
+template<class It, class F>
+void parallel_for_each(It first, It last, F f, thread_pool& pool = thread_pool::default_pool())
+{
+    auto r = range_detail::unwrap(first,last);
+    typedef typename std::iterator_traits<It>::value_type T;
+    parallel_detail::for_chunks(r.first,r.last,parallel_detail::chunk_size<T>(),pool,
+        [&f](decltype(r.first) b, decltype(r.first) e, std::ptrdiff_t){ std::for_each(b,e,f); });
+}
+
+// out must be random access and have room for last-first elements
+template<class It, class Out, class F>
+Out parallel_transform(It first, It last, Out out, F f, thread_pool& pool = thread_pool::default_pool())
+{
+    auto r = range_detail::unwrap(first,last);
+    auto o = range_detail::unwrap(out,out+(last-first));
+    typedef typename std::iterator_traits<It>::value_type T;
+    auto src = r.first;
+    auto dst = o.first;
+    parallel_detail::for_chunks(r.first,r.last,parallel_detail::chunk_size<T>(),pool,
+        [&](decltype(r.first) b, decltype(r.first) e, std::ptrdiff_t){ std::transform(b,e,dst+(b-src),f); });
+    return o.result(o.last);
+}
+
+// op must be associative; partial results are combined in range order
+template<class It, class U, class Op>
+U parallel_reduce(It first, It last, U init, Op op, thread_pool& pool = thread_pool::default_pool())
+{
+    auto r = range_detail::unwrap(first,last);
+    typedef typename std::iterator_traits<It>::value_type T;
+    std::ptrdiff_t chunk = parallel_detail::chunk_size<T>();
+    std::ptrdiff_t n = r.last-r.first;
+    if(n==0) return init;
+    std::vector<U> partial((n+chunk-1)/chunk);
+    parallel_detail::for_chunks(r.first,r.last,chunk,pool,
+        [&](decltype(r.first) b, decltype(r.first) e, std::ptrdiff_t k){
+            U acc = *b;
+            for(++b ; b!=e ; ++b) acc = op(acc,*b);
+            partial[k] = acc;
+        });
+    for(std::size_t k=0 ; k<partial.size() ; ++k) init = op(init,partial[k]);
+    return init;
+}
+
+template<class It, class U>
+U parallel_reduce(It first, It last, U init, thread_pool& pool = thread_pool::default_pool())
+{
+    return parallel_reduce(first,last,init,std::plus<U>(),pool);
+}
+
+// the first match, like std::find; chunks behind an earlier hit are skipped
+template<class It, class U>
+It parallel_find(It first, It last, const U& val, thread_pool& pool = thread_pool::default_pool())
+{
+    auto r = range_detail::unwrap(first,last);
+    typedef typename std::iterator_traits<It>::value_type T;
+    std::ptrdiff_t n = r.last-r.first;
+    std::atomic<std::ptrdiff_t> best(n);
+    auto base = r.first;
+    parallel_detail::for_chunks(r.first,r.last,parallel_detail::chunk_size<T>(),pool,
+        [&](decltype(r.first) b, decltype(r.first) e, std::ptrdiff_t){
+            if(best.load(std::memory_order_relaxed)<b-base) return;
+            auto p = std::find(b,e,val);
+            if(p==e) return;
+            std::ptrdiff_t i = p-base;
+            std::ptrdiff_t cur = best.load();
+            while(i<cur && !best.compare_exchange_weak(cur,i)) {}
+        });
+    return r.result(r.first+best.load());
+}
+
+namespace parallel_detail {
+
+// blocks sorted in parallel with block_sort, then merged pairwise, each round in parallel
+template<class P, class Compare, class BlockSort>
+void sort_blocks(P first, P last, Compare comp, BlockSort block_sort, thread_pool& pool)
+{
+    std::ptrdiff_t n = last-first;
+    std::ptrdiff_t parts = 1;
+    while(parts<2*std::ptrdiff_t(pool.size()) && n/(2*parts)>=4096) parts *= 2;
+    if(parts==1){
+        block_sort(first,last);
+        return;
+    }
+
+    std::ptrdiff_t step = (n+parts-1)/parts;
+    {
+        task_group g(pool);
+        for(std::ptrdiff_t i=0 ; i<n ; i+=step){
+            std::ptrdiff_t e = std::min(n,i+step);
+            g.run([=,&block_sort]{ block_sort(first+i,first+e); });
+        }
+        g.wait();
+    }
+    for( ; step<n ; step*=2){
+        task_group g(pool);
+        for(std::ptrdiff_t i=0 ; i+step<n ; i+=2*step){
+            std::ptrdiff_t e = std::min(n,i+2*step);
+            g.run([=,&comp]{ std::inplace_merge(first+i,first+i+step,first+e,comp); });
+        }
+        g.wait();
+    }
+}
+
+}   // namespace parallel_detail
+
+template<class It, class Compare>
+void parallel_sort(It first, It last, Compare comp, thread_pool& pool = thread_pool::default_pool())
+{
+    auto r = range_detail::unwrap(first,last);
+    typedef decltype(r.first) P;
+    parallel_detail::sort_blocks(r.first,r.last,comp,[&comp](P b, P e){ std::sort(b,e,comp); },pool);
+}
+
+// without a comparator, blocks of std::string go through string_sort
+template<class It>
+void parallel_sort(It first, It last, thread_pool& pool = thread_pool::default_pool())
+{
+    auto r = range_detail::unwrap(first,last);
+    typedef decltype(r.first) P;
+    typedef typename std::iterator_traits<It>::value_type T;
+    parallel_detail::sort_blocks(r.first,r.last,std::less<T>(),
+                                 [](P b, P e){ string_sort_detail::default_sort(b,e); },pool);
+}
+
+template<class T, class A, class C, class G, class Compare>
+void parallel_sort(vector<T,A,C,G>& v, Compare comp, thread_pool& pool = thread_pool::default_pool())
+{
+    parallel_sort(v.begin(),v.end(),comp,pool);
+}
+
+template<class T, class A, class C, class G>
+void parallel_sort(vector<T,A,C,G>& v, thread_pool& pool = thread_pool::default_pool())
+{
+    parallel_sort(v.begin(),v.end(),pool);
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,111 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+#include "vector.h"
+#include "allocators.h"
+#include "checked_range.h"
+#include "simd_kernels.h"
+
+// vectorized algorithms over vector<int>, vector<float> and vector<double>
+// ranges, with the instruction set picked at run time (see simd_kernels.h).
+// other element types get the std algorithm
+
+// vector storage in blocks that start on a cache line. data() is that start
+// until a prefix erase, pop_front or push_front moves begin() into the front
+// gap (shrink_to_fit or a copy puts the elements back at a block start), so
+// the kernels don't count on it: they use unaligned loads, which cost the
+// same on aligned data
+template<class T> using simd_vector = vector<T,aligned_allocator<T> >;
+
+// all of these take plain iterators or checked_iterators (a checked pair is
+// validated once and the kernel runs on the pointers underneath)
+
+template<class It, class U>
+It simd_find(It first, It last, const U& v)
+{
+    auto r = range_detail::unwrap(first,last);
+    auto f = simd_detail::as_const(r.first);
+    return r.result(r.first+(simd_detail::find(f,simd_detail::as_const(r.last),v)-f));
+}
+
+template<class It, class U>
+int simd_count(It first, It last, const U& v)
+{
+    auto r = range_detail::unwrap(first,last);
+    return simd_detail::count(simd_detail::as_const(r.first),simd_detail::as_const(r.last),v);
+}
+
+// the range must not be empty
+template<class It>
+typename std::iterator_traits<It>::value_type simd_min(It first, It last)
+{
+    auto r = range_detail::unwrap(first,last);
+    assert(r.first!=r.last);
+    return simd_detail::min(simd_detail::as_const(r.first),simd_detail::as_const(r.last));
+}
+
+template<class It>
+typename std::iterator_traits<It>::value_type simd_max(It first, It last)
+{
+    auto r = range_detail::unwrap(first,last);
+    assert(r.first!=r.last);
+    return simd_detail::max(simd_detail::as_const(r.first),simd_detail::as_const(r.last));
+}
+
+// ints add up in long long
+template<class It>
+auto simd_sum(It first, It last) -> decltype(simd_detail::sum(simd_detail::as_const(&*first),simd_detail::as_const(&*first)))
+{
+    auto r = range_detail::unwrap(first,last);
+    return simd_detail::sum(simd_detail::as_const(r.first),simd_detail::as_const(r.last));
+}
+
+template<class It, class It2>
+auto simd_dot(It first, It last, It2 first2) -> decltype(simd_detail::sum(simd_detail::as_const(&*first),simd_detail::as_const(&*first)))
+{
+    auto r = range_detail::unwrap(first,last);
+    auto r2 = range_detail::unwrap(first2,first2+(last-first));
+    return simd_detail::dot(simd_detail::as_const(r.first),simd_detail::as_const(r.last),simd_detail::as_const(r2.first));
+}
+
+template<class It, class It2>
+bool simd_equal(It first, It last, It2 first2)
+{
+    auto r = range_detail::unwrap(first,last);
+    auto r2 = range_detail::unwrap(first2,first2+(last-first));
+    return simd_detail::equal(simd_detail::as_const(r.first),simd_detail::as_const(r.last),simd_detail::as_const(r2.first));
+}
+
+template<class It, class U>
+void simd_fill(It first, It last, const U& v)
+{
+    auto r = range_detail::unwrap(first,last);
+    simd_detail::fill(r.first,r.last,typename std::iterator_traits<It>::value_type(v));
+}
+
+// out[i] = a[i]+b[i]; out may be a or b, but must not partly overlap them
+template<class It, class It2, class Out>
+Out simd_add(It first, It last, It2 first2, Out out)
+{
+    auto r = range_detail::unwrap(first,last);
+    auto r2 = range_detail::unwrap(first2,first2+(last-first));
+    auto o = range_detail::unwrap(out,out+(last-first));
+    simd_detail::add(simd_detail::as_const(r.first),simd_detail::as_const(r.last),simd_detail::as_const(r2.first),o.first);
+    return o.result(o.last);
+}
+
+// out[i] = a[i]*k; out may be a, but must not partly overlap it
+template<class It, class U, class Out>
+Out simd_scale(It first, It last, const U& k, Out out)
+{
+    auto r = range_detail::unwrap(first,last);
+    auto o = range_detail::unwrap(out,out+(last-first));
+    simd_detail::scale(simd_detail::as_const(r.first),simd_detail::as_const(r.last),
+                       typename std::iterator_traits<It>::value_type(k),o.first);
+    return o.result(o.last);
+}
+
+#endif // SIMD_H
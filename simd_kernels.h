@@ -0,0 +1,189 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+
+// the kernels behind simd.h (and checked_range.h's find): find, count,
+// min/max, sum, dot, fill, equal, add and scale over int, float and double.
+// each is compiled once per instruction set (SSE2, AVX2, AVX-512) with
+// target_clones, and the loader picks the best one the CPU has. the loops
+// are written so that each clone vectorizes them: sums and min/max keep a row
+// of independent lanes (so float sums add in a different order than
+// std::accumulate would), searches test a block of lanes at once and only
+// look at single elements in the block that hit. other element types get
+// the std algorithm
+
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__linux__) && !defined(VECTOR_NO_SIMD_DISPATCH)
+#  define VECTOR_SIMD_CLONES __attribute__((target_clones("default","avx2","avx512f")))
+#else
+#  define VECTOR_SIMD_CLONES
+#endif
+
+namespace simd_detail {
+
+// what a sum of T adds up in: ints are widened so a long vector can't overflow
+template<class T> struct sum_type { typedef T type; };
+template<> struct sum_type<int> { typedef long long type; };
+
+// lanes per block: 128 bytes, two AVX-512 or four AVX2 registers
+template<class T> struct lanes { static const int value = 128/sizeof(T); };
+
+// the bodies are inlined into each clone, which is what vectorizes them for its ISA
+#define VECTOR_SIMD_BODY inline __attribute__((always_inline))
+
+template<class T>
+VECTOR_SIMD_BODY const T* find_body(const T* p, const T* last, T v)
+{
+    const int L = lanes<T>::value;
+    for( ; L<=last-p ; p+=L){
+        int hit = 0;
+        for(int j=0 ; j<L ; ++j) hit |= p[j]==v;
+        if(hit) break;
+    }
+    for( ; p!=last ; ++p)
+        if(*p==v) return p;
+    return last;
+}
+
+template<class T>
+VECTOR_SIMD_BODY int count_body(const T* p, const T* last, T v)
+{
+    int n = 0;
+    for( ; p!=last ; ++p) n += *p==v;
+    return n;
+}
+
+template<class T>
+VECTOR_SIMD_BODY T min_body(const T* p, const T* last)
+{
+    const int L = lanes<T>::value;
+    T m[L];
+    for(int j=0 ; j<L ; ++j) m[j] = *p;
+    for( ; L<=last-p ; p+=L)
+        for(int j=0 ; j<L ; ++j) m[j] = p[j]<m[j] ? p[j] : m[j];
+    for( ; p!=last ; ++p) m[0] = *p<m[0] ? *p : m[0];
+    for(int j=1 ; j<L ; ++j) m[0] = m[j]<m[0] ? m[j] : m[0];
+    return m[0];
+}
+
+template<class T>
+VECTOR_SIMD_BODY T max_body(const T* p, const T* last)
+{
+    const int L = lanes<T>::value;
+    T m[L];
+    for(int j=0 ; j<L ; ++j) m[j] = *p;
+    for( ; L<=last-p ; p+=L)
+        for(int j=0 ; j<L ; ++j) m[j] = m[j]<p[j] ? p[j] : m[j];
+    for( ; p!=last ; ++p) m[0] = m[0]<*p ? *p : m[0];
+    for(int j=1 ; j<L ; ++j) m[0] = m[0]<m[j] ? m[j] : m[0];
+    return m[0];
+}
+
+template<class T>
+VECTOR_SIMD_BODY typename sum_type<T>::type sum_body(const T* p, const T* last)
+{
+    typedef typename sum_type<T>::type S;
+    const int L = lanes<T>::value;
+    S s[L] = {};
+    for( ; L<=last-p ; p+=L)
+        for(int j=0 ; j<L ; ++j) s[j] += p[j];
+    for( ; p!=last ; ++p) s[0] += *p;
+    for(int j=1 ; j<L ; ++j) s[0] += s[j];
+    return s[0];
+}
+
+template<class T>
+VECTOR_SIMD_BODY typename sum_type<T>::type dot_body(const T* a, const T* last, const T* b)
+{
+    typedef typename sum_type<T>::type S;
+    const int L = lanes<T>::value;
+    S s[L] = {};
+    for( ; L<=last-a ; a+=L, b+=L)
+        for(int j=0 ; j<L ; ++j) s[j] += S(a[j])*b[j];
+    for( ; a!=last ; ++a, ++b) s[0] += S(*a)*(*b);
+    for(int j=1 ; j<L ; ++j) s[0] += s[j];
+    return s[0];
+}
+
+template<class T>
+VECTOR_SIMD_BODY bool equal_body(const T* a, const T* last, const T* b)
+{
+    const int L = lanes<T>::value;
+    for( ; L<=last-a ; a+=L, b+=L){
+        int diff = 0;
+        for(int j=0 ; j<L ; ++j) diff |= !(a[j]==b[j]);
+        if(diff) return false;
+    }
+    for( ; a!=last ; ++a, ++b)
+        if(!(*a==*b)) return false;
+    return true;
+}
+
+// the kernels themselves, one set per element type. add and scale may write
+// over an input (out==a or out==b), so none of their pointers is __restrict:
+// the compiler checks the overlap at run time and keeps the vector loop for
+// the disjoint and the in-place case
+#define VECTOR_SIMD_KERNELS(T) \
+    VECTOR_SIMD_CLONES inline const T* find(const T* f, const T* l, T v) { return find_body(f,l,v); } \
+    VECTOR_SIMD_CLONES inline int count(const T* f, const T* l, T v) { return count_body(f,l,v); } \
+    VECTOR_SIMD_CLONES inline T min(const T* f, const T* l) { return min_body(f,l); } \
+    VECTOR_SIMD_CLONES inline T max(const T* f, const T* l) { return max_body(f,l); } \
+    VECTOR_SIMD_CLONES inline sum_type<T>::type sum(const T* f, const T* l) { return sum_body(f,l); } \
+    VECTOR_SIMD_CLONES inline sum_type<T>::type dot(const T* f, const T* l, const T* g) { return dot_body(f,l,g); } \
+    VECTOR_SIMD_CLONES inline bool equal(const T* f, const T* l, const T* g) { return equal_body(f,l,g); } \
+    VECTOR_SIMD_CLONES inline void fill(T* f, T* l, T v) { for( ; f!=l ; ++f) *f = v; } \
+    VECTOR_SIMD_CLONES inline void add(const T* a, const T* l, const T* b, T* out) \
+        { for(std::ptrdiff_t i=0, n=l-a ; i<n ; ++i) out[i] = a[i]+b[i]; } \
+    VECTOR_SIMD_CLONES inline void scale(const T* a, const T* l, T k, T* out) \
+        { for(std::ptrdiff_t i=0, n=l-a ; i<n ; ++i) out[i] = a[i]*k; }
+
+VECTOR_SIMD_KERNELS(int)
+VECTOR_SIMD_KERNELS(float)
+VECTOR_SIMD_KERNELS(double)
+
+#undef VECTOR_SIMD_KERNELS
+#undef VECTOR_SIMD_BODY
+
+// everything else: the std algorithms. the kernels above are exact matches
+// for const int/float/double* and a value of the same type, so they win
+template<class P, class U> P find(P f, P l, const U& v) { return std::find(f,l,v); }
+template<class P, class U> int count(P f, P l, const U& v) { return int(std::count(f,l,v)); }
+template<class P> typename std::iterator_traits<P>::value_type min(P f, P l) { return *std::min_element(f,l); }
+template<class P> typename std::iterator_traits<P>::value_type max(P f, P l) { return *std::max_element(f,l); }
+template<class P> typename std::iterator_traits<P>::value_type sum(P f, P l)
+{
+    return std::accumulate(f,l,typename std::iterator_traits<P>::value_type());
+}
+template<class P, class Q> typename std::iterator_traits<P>::value_type dot(P f, P l, Q g)
+{
+    return std::inner_product(f,l,g,typename std::iterator_traits<P>::value_type());
+}
+template<class P, class Q> bool equal(P f, P l, Q g) { return std::equal(f,l,g); }
+template<class P, class U> void fill(P f, P l, const U& v) { std::fill(f,l,v); }
+template<class P, class Q, class O> void add(P a, P l, Q b, O out) { std::transform(a,l,b,out,std::plus<typename std::iterator_traits<P>::value_type>()); }
+template<class P, class U, class O> void scale(P a, P l, const U& k, O out) { for( ; a!=l ; ++a, ++out) *out = *a*k; }
+
+// const T* for pointers, so the kernels match; other iterators as they are
+template<class P> const P* as_const(P* p) { return p; }
+template<class It> It as_const(It p) { return p; }
+
+}   // namespace simd_detail
+
+// which clone the loader picked, for benchmarks and logs
+inline const char* simd_dispatch_isa()
+{
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__linux__) && !defined(VECTOR_NO_SIMD_DISPATCH)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return "avx512f";
+    if(__builtin_cpu_supports("avx2")) return "avx2";
+    return "sse2";
+#else
+    return "none";
+#endif
+}
+
+#endif // SIMD_KERNELS_H
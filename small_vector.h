@@ -0,0 +1,169 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <type_traits>
+#include <iterator>
+#include "vector.h"
+
+// hands out one block of N slots that lives inside the owning small_vector,
+// and falls back to A once a bigger block is asked for (or the slots are taken)
+template<class T, int N, class A = std::allocator<T> >
+class inline_allocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<class U> struct rebind {     // rebound copies can't use the slots
+        typedef inline_allocator<U,N,typename std::allocator_traits<A>::template rebind_alloc<U> > other;
+    };
+
+    explicit inline_allocator(T* slots = 0, const A& a = A()) : heap(a), buf(slots), used(false) {}
+    template<class U, class B>
+    inline_allocator(const inline_allocator<U,N,B>& o) : heap(o.heap), buf(0), used(false) {}
+
+    // a vector copied out of a small_vector must not share its slots
+    inline_allocator select_on_container_copy_construction() const { return inline_allocator(0,heap); }
+
+    T* allocate(size_type n)
+    {
+        if(buf && !used && n<=size_type(N)){
+            used = true;
+            return buf;
+        }
+        return heap.allocate(n);
+    }
+
+    void deallocate(T* p, size_type n)
+    {
+        if(p && p==buf) used = false;
+        else heap.deallocate(p,n);
+    }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) { ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    template<class U>
+    void destroy(U* p) { p->~U(); }
+
+    bool owns(const T* p) const { return buf && buf<=p && p<=buf+N; }
+
+    A heap;
+    T* buf;
+    bool used;
+};
+
+template<class T, int N, class A>
+bool operator==(const inline_allocator<T,N,A>& a, const inline_allocator<T,N,A>& b) { return a.buf==b.buf && a.heap==b.heap; }
+
+template<class T, int N, class A>
+bool operator!=(const inline_allocator<T,N,A>& a, const inline_allocator<T,N,A>& b) { return !(a==b); }
+
+template<class T, int N>
+class small_vector_slots {  // a base, so the slots exist before the vector that uses them
+    typename std::aligned_storage<sizeof(T),alignof(T)>::type slots[N];
+protected:
+    T* inline_slots() { return reinterpret_cast<T*>(slots); }
+};
+
+// vector<T,A> that keeps up to N elements inside the object itself and only
+// goes to the heap beyond that. everything else (at, [], insert, erase,
+// checked_iterator...) is vector's
+template<class T, int N, class A = std::allocator<T> >
+class small_vector : private small_vector_slots<T,N>, public vector<T,inline_allocator<T,N,A> > {
+    static_assert(N>0,"small_vector needs at least one inline slot");
+    typedef vector<T,inline_allocator<T,N,A> > base;
+
+public:
+    small_vector() : base(inline_allocator<T,N,A>(this->inline_slots())) { this->reserve(N); }
+
+    explicit small_vector(int n, const T& def = T())
+        : base(inline_allocator<T,N,A>(this->inline_slots()))
+    {
+        this->reserve(N);
+        this->assign(n,def);
+    }
+
+    small_vector(const small_vector& v)
+        : small_vector_slots<T,N>(), base(inline_allocator<T,N,A>(this->inline_slots()))
+    {
+        this->reserve(N);
+        this->assign(v.begin(),v.end());
+    }
+
+    small_vector& operator=(const small_vector& v)
+    {
+        base::operator=(v);
+        return *this;
+    }
+
+    // a heap block is handed over; inline elements can only be moved one by one
+    small_vector(small_vector&& v)
+        : base(inline_allocator<T,N,A>(this->inline_slots()))
+    {
+        this->reserve(N);
+        take(v);
+    }
+
+    small_vector& operator=(small_vector&& v)
+    {
+        if(this!=&v) take(v);
+        return *this;
+    }
+
+    void swap(small_vector& v)
+    {
+        small_vector tmp(std::move(v));
+        v = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    // elements that fit the slots go (or stay) there, with the whole N as
+    // capacity; only a vector bigger than that is shrunk on the heap
+    void shrink_to_fit()
+    {
+        if(N<this->size()){
+            base::shrink_to_fit();
+            return;
+        }
+        if(this->is_inline() && this->front_capacity()==0) return;
+        small_vector tmp;
+        tmp.assign(std::make_move_iterator(this->begin()),std::make_move_iterator(this->end()));
+        this->clear();
+        base::shrink_to_fit();  // an empty vector gives its block back, slots or heap
+        this->reserve(N);
+        this->assign(std::make_move_iterator(tmp.begin()),std::make_move_iterator(tmp.end()));
+    }
+
+    bool is_inline() const  // begin() can sit past the slots' start, after erasing a prefix
+    {
+        return inline_begin()<=this->begin() && this->begin()<=inline_begin()+N;
+    }
+    static int inline_capacity() { return N; }
+
+private:
+    void take(small_vector& v)
+    {
+        if(!v.is_inline() && this->get_allocator().heap==v.get_allocator().heap){
+            this->adopt(v);
+            v.reserve(N);   // back on its own slots
+            return;
+        }
+        this->assign(std::make_move_iterator(v.begin()),std::make_move_iterator(v.end()));
+        v.clear();
+    }
+
+    const T* inline_begin() const { return const_cast<small_vector*>(this)->inline_slots(); }
+};
+
+template<class T, int N, class A>
+void swap(small_vector<T,N,A>& a, small_vector<T,N,A>& b)
+{
+    a.swap(b);
+}
+
+#endif // SMALL_VECTOR_H
@@ -0,0 +1,396 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <limits.h>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "vector.h"
+
+// binary snapshots of a vector<T,A>: a 64 byte header (element count, type
+// tag, payload size and checksum) followed by the payload, either the raw
+// element bytes for trivially copyable T or one record per string, a uint32
+// length then the bytes. save() writes path.tmp straight from the elements
+// with writev(2), IOV_MAX pieces at a time (the raw bytes are one piece, a
+// string two), and renames it over path once it is synced; load() maps the
+// file and copies the payload with a single memcpy, or snapshot_view<T>
+// leaves it in the page cache and reads it in place. the byte order is the
+// machine's
+
+struct snapshot_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t elem_size;    // 0 for string records
+    std::uint64_t type_tag;
+    std::uint64_t count;
+    std::uint64_t payload_bytes;
+    std::uint64_t checksum;     // of the payload
+    char reserved[16];
+};
+
+// what identifies T in a snapshot: size, alignment and kind of arithmetic
+// type. specialize it to tell apart structs that would otherwise agree
+template<class T>
+struct snapshot_type_tag {
+    static const std::uint64_t value = std::uint64_t(sizeof(T)) | std::uint64_t(alignof(T)) << 16
+                                     | std::uint64_t(std::is_integral<T>::value) << 32
+                                     | std::uint64_t(std::is_floating_point<T>::value) << 33
+                                     | std::uint64_t(std::is_signed<T>::value) << 34;
+};
+
+template<>
+struct snapshot_type_tag<std::string> {
+    static const std::uint64_t value = 0x737472696e670000ULL;  // "string"
+};
+
+namespace snapshot_detail {
+
+const std::size_t header_size = 64;
+static_assert(sizeof(snapshot_header)==header_size,"the header is part of the file format");
+
+#ifdef IOV_MAX
+const int max_iov = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+const int max_iov = 16;     // the least POSIX allows
+#endif
+
+// four independent multiply-xorshift lanes over 8 byte words, so it runs
+// near memory speed; not cryptographic, it catches torn and corrupt files.
+// the payload can come in any number of pieces: the lanes see the same 32
+// byte blocks however it is cut, and the bytes past the last block finish it
+class checksummer {
+public:
+    checksummer() : buffered(0)
+    {
+        for(int i=0 ; i<4 ; ++i) h[i] = m^std::uint64_t(i);
+    }
+
+    void add(const void* data, std::size_t n)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        if(buffered){
+            std::size_t k = n<32-buffered ? n : 32-buffered;
+            std::memcpy(buf+buffered,p,k);
+            buffered += k;
+            p += k;
+            n -= k;
+            if(buffered<32) return;
+            block(buf);
+            buffered = 0;
+        }
+        for( ; 32<=n ; p+=32, n-=32) block(p);
+        std::memcpy(buf,p,n);
+        buffered = n;
+    }
+
+    std::uint64_t value() const
+    {
+        std::uint64_t r = h[0] ^ (h[1]<<1 | h[1]>>63) ^ (h[2]<<2 | h[2]>>62) ^ (h[3]<<3 | h[3]>>61);
+        for(std::size_t i=0 ; i<buffered ; ++i) r = (r^buf[i])*0x100000001b3ULL;
+        return (r^(r>>29))*m;
+    }
+
+private:
+    static const std::uint64_t m = 0x9e3779b97f4a7c15ULL;
+
+    void block(const unsigned char* p)
+    {
+        for(int i=0 ; i<4 ; ++i){
+            std::uint64_t w;
+            std::memcpy(&w,p+8*i,8);
+            h[i] = (h[i]^w)*0xff51afd7ed558ccdULL;
+            h[i] ^= h[i]>>32;
+        }
+    }
+
+    std::uint64_t h[4];
+    unsigned char buf[32];
+    std::size_t buffered;
+};
+
+inline std::uint64_t checksum(const void* data, std::size_t n)
+{
+    checksummer c;
+    c.add(data,n);
+    return c.value();
+}
+
+inline void fail(const char* what, const char* path)
+{
+    throw std::system_error(errno,std::generic_category(),std::string("snapshot: ")+what+" "+path);
+}
+
+inline void corrupt(const char* path, const char* why)
+{
+    throw std::runtime_error(std::string("snapshot: ")+path+" "+why);
+}
+
+// writes every iovec, normally in the one writev call
+inline void write_all(int fd, iovec* iov, int n, const char* path)
+{
+    while(n){
+        ssize_t r = ::writev(fd,iov,n);
+        if(r<0){
+            if(errno==EINTR) continue;
+            fail("writev",path);
+        }
+        for( ; n && std::size_t(r)>=iov->iov_len ; ++iov, --n) r -= iov->iov_len;
+        if(n){
+            iov->iov_base = static_cast<char*>(iov->iov_base)+r;
+            iov->iov_len -= r;
+        }
+    }
+}
+
+// the payload on its way to fd: pieces are gathered max_iov to a writev and
+// checksummed as they are added. nothing is copied but the string lengths,
+// which wait here for their writev
+class payload_writer {
+public:
+    payload_writer(int file, const char* p) : fd(file), path(p), n(0), nlen(0) {}
+
+    void add(const void* data, std::size_t bytes)
+    {
+        if(bytes==0) return;
+        sum.add(data,bytes);
+        iov[n].iov_base = const_cast<void*>(data);
+        iov[n].iov_len = bytes;
+        if(++n==max_iov) flush();
+    }
+
+    void add_length(std::uint32_t len)
+    {
+        lens[nlen] = len;
+        add(&lens[nlen++],4);
+    }
+
+    void flush()
+    {
+        write_all(fd,iov,n,path);
+        n = nlen = 0;
+    }
+
+    std::uint64_t checksum() const { return sum.value(); }
+
+private:
+    int fd;
+    const char* path;
+    int n;
+    int nlen;
+    iovec iov[max_iov];
+    std::uint32_t lens[max_iov];
+    checksummer sum;
+};
+
+// a rename only lasts a crash once the directory holding path is synced
+inline void sync_dir(const char* path)
+{
+    const char* slash = std::strrchr(path,'/');
+    std::string dir = slash ? std::string(path,slash==path ? 1 : slash-path) : std::string(".");
+    int fd = ::open(dir.c_str(),O_RDONLY|O_DIRECTORY);
+    if(fd<0) fail("open",dir.c_str());
+    int r = ::fsync(fd);
+    ::close(fd);
+    if(r!=0) fail("fsync",dir.c_str());
+}
+
+// writes path.tmp, syncs it, renames it over path and syncs the directory, so
+// path holds either the old snapshot or the whole new one, never a torn mix
+// of the two. emit(payload_writer&) adds the payload after the header, which
+// goes in last, once the checksum is known
+template<class Emit>
+void write_file(const char* path, snapshot_header& h, Emit emit)
+{
+    std::string tmp = std::string(path)+".tmp";
+    int fd = ::open(tmp.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+    if(fd<0) fail("open",tmp.c_str());
+    try{
+        if(::lseek(fd,off_t(header_size),SEEK_SET)<0) fail("lseek",tmp.c_str());
+        std::unique_ptr<payload_writer> w(new payload_writer(fd,tmp.c_str()));
+        emit(*w);
+        w->flush();
+        h.checksum = w->checksum();
+        iovec head = { &h, header_size };
+        if(::lseek(fd,0,SEEK_SET)<0) fail("lseek",tmp.c_str());
+        write_all(fd,&head,1,tmp.c_str());
+        if(::fsync(fd)!=0) fail("fsync",tmp.c_str());
+        int r = ::close(fd);
+        fd = -1;
+        if(r!=0) fail("close",tmp.c_str());
+        if(::rename(tmp.c_str(),path)!=0) fail("rename",path);
+    }catch(...){
+        if(0<=fd) ::close(fd);
+        ::unlink(tmp.c_str());
+        throw;
+    }
+    sync_dir(path);
+}
+
+inline snapshot_header make_header(std::uint32_t elem_size, std::uint64_t tag, std::uint64_t count, std::uint64_t bytes)
+{
+    snapshot_header h;
+    std::memset(&h,0,sizeof(h));
+    std::memcpy(h.magic,"VECSNAP1",8);
+    h.version = 1;
+    h.elem_size = elem_size;
+    h.type_tag = tag;
+    h.count = count;
+    h.payload_bytes = bytes;
+    return h;
+}
+
+// a whole snapshot file, mapped read only and checked
+class mapping {
+public:
+    mapping(const char* path, std::uint32_t elem_size, std::uint64_t tag, bool verify)
+        : base(0), bytes(0)
+    {
+        int fd = ::open(path,O_RDONLY);
+        if(fd<0) fail("open",path);
+        struct stat st;
+        if(fstat(fd,&st)!=0){
+            ::close(fd);
+            fail("fstat",path);
+        }
+        bytes = std::size_t(st.st_size);
+        if(bytes<header_size){
+            ::close(fd);
+            corrupt(path,"is too short for a header");
+        }
+        void* p = ::mmap(0,bytes,PROT_READ,MAP_PRIVATE,fd,0);
+        ::close(fd);    // the mapping keeps the file
+        if(p==MAP_FAILED) fail("mmap",path);
+        base = static_cast<const char*>(p);
+
+        const snapshot_header& h = head();
+        try{
+            if(std::memcmp(h.magic,"VECSNAP1",8)!=0 || h.version!=1) corrupt(path,"is not a vector snapshot");
+            if(h.elem_size!=elem_size || h.type_tag!=tag) corrupt(path,"holds elements of another type");
+            if(bytes-header_size<h.payload_bytes) corrupt(path,"is truncated");
+            // the count is checked against the payload before anything is sized
+            // by it: elem_size bytes an element, or at least a length per string
+            if(elem_size ? h.payload_bytes%elem_size || h.payload_bytes/elem_size!=h.count
+                         : h.payload_bytes/4<h.count)
+                corrupt(path,"has an element count that doesn't match its payload");
+            if(std::uint64_t(INT_MAX)<h.count) corrupt(path,"holds more elements than a vector can");
+            if(verify && checksum(payload(),h.payload_bytes)!=h.checksum) corrupt(path,"fails its checksum");
+        }catch(...){
+            ::munmap(const_cast<char*>(base),bytes);
+            throw;
+        }
+    }
+
+    ~mapping() { ::munmap(const_cast<char*>(base),bytes); }
+
+    const snapshot_header& head() const { return *reinterpret_cast<const snapshot_header*>(base); }
+    const char* payload() const { return base+header_size; }
+
+private:
+    const char* base;
+    std::size_t bytes;
+
+    mapping(const mapping&);
+    mapping& operator=(const mapping&);
+};
+
+}   // namespace snapshot_detail
+
+template<class T, class A, class C, class G>
+void save_snapshot(const char* path, const vector<T,A,C,G>& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value,"only trivially copyable elements (and std::string) are saved as bytes");
+    snapshot_header h = snapshot_detail::make_header(sizeof(T),snapshot_type_tag<T>::value,v.size(),
+                                                     std::uint64_t(v.size())*sizeof(T));
+    const T* first = v.begin();
+    snapshot_detail::write_file(path,h,[&](snapshot_detail::payload_writer& w){ w.add(first,std::size_t(h.payload_bytes)); });
+}
+
+template<class A, class C, class G>
+void save_snapshot(const char* path, const vector<std::string,A,C,G>& v)
+{
+    std::size_t bytes = 0;
+    for(int i=0 ; i<v.size() ; ++i){
+        if(0xffffffffu<v[i].size()) throw std::length_error("snapshot: string longer than 4 GB");
+        bytes += 4+v[i].size();
+    }
+    snapshot_header h = snapshot_detail::make_header(0,snapshot_type_tag<std::string>::value,v.size(),bytes);
+    snapshot_detail::write_file(path,h,[&](snapshot_detail::payload_writer& w){
+        for(int i=0 ; i<v.size() ; ++i){
+            w.add_length(std::uint32_t(v[i].size()));
+            w.add(v[i].data(),v[i].size());
+        }
+    });
+}
+
+// replaces v's elements with the snapshot's; verify=false skips the checksum pass
+template<class T, class A, class C, class G>
+void load_snapshot(const char* path, vector<T,A,C,G>& v, bool verify = true)
+{
+    static_assert(std::is_trivially_copyable<T>::value,"only trivially copyable elements (and std::string) are loaded as bytes");
+    snapshot_detail::mapping m(path,sizeof(T),snapshot_type_tag<T>::value,verify);
+    const T* first = reinterpret_cast<const T*>(m.payload());
+    v.assign(first,first+m.head().count);    // one memcpy, see vector::assign
+}
+
+template<class A, class C, class G>
+void load_snapshot(const char* path, vector<std::string,A,C,G>& v, bool verify = true)
+{
+    snapshot_detail::mapping m(path,0,snapshot_type_tag<std::string>::value,verify);
+    const char* p = m.payload();
+    const char* end = p+m.head().payload_bytes;
+    v.clear();
+    v.reserve(int(m.head().count));        // mapping checked it against the payload
+    for(std::uint64_t i=0 ; i<m.head().count ; ++i){
+        std::uint32_t len;
+        if(end-p<4) snapshot_detail::corrupt(path,"is truncated");
+        std::memcpy(&len,p,4);
+        if(std::size_t(end-p-4)<len) snapshot_detail::corrupt(path,"is truncated");
+        v.emplace_back(p+4,std::size_t(len));
+        p += 4+len;
+    }
+}
+
+// a snapshot of trivially copyable T, read where it lies in the mapping
+template<class T>
+class snapshot_view {
+    static_assert(std::is_trivially_copyable<T>::value,"snapshot_view reads raw bytes");
+
+public:
+    typedef T value_type;
+    typedef const T* iterator;
+    typedef const T* const_iterator;
+
+    explicit snapshot_view(const char* path, bool verify = true)
+        : map(path,sizeof(T),snapshot_type_tag<T>::value,verify),
+          first(reinterpret_cast<const T*>(map.payload())), sz(int(map.head().count)) {}
+
+    const T& at(int n) const
+    {
+        if(n<0 || sz<=n) throw Range_error(n);
+        return first[n];
+    }
+    const T& operator[](int i) const { return first[i]; }
+
+    const_iterator begin() const { return first; }
+    const_iterator end() const { return first+sz; }
+    int size() const { return sz; }
+
+private:
+    snapshot_detail::mapping map;
+    const T* first;
+    int sz;
+};
+
+#endif // SNAPSHOT_H
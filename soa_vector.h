@@ -0,0 +1,340 @@
+#ifndef SOA_VECTOR_H
+#define SOA_VECTOR_H
+
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include "vector.h"
+#include "allocators.h"
+
+// structure of arrays: soa_vector<int,float,char> keeps one contiguous column
+// per field instead of one array of structs, so a loop reading one field
+// streams through that column only. the columns are vector<Field> over
+// aligned_allocator (a new block starts on a cache line) and never use
+// vector's front gap, so every column starts its block; elements are
+// handed out as proxies, tuples of references into the columns
+
+// one column, as a plain contiguous range: what loops should run over
+template<class T>
+class column_span {
+public:
+    typedef T value_type;
+    typedef T* iterator;
+
+    column_span(T* p, int n) : first(p), sz(n) {}
+
+    T* data() const { return first; }
+    T* begin() const { return first; }
+    T* end() const { return first+sz; }
+    int size() const { return sz; }
+    T& operator[](int i) const { return first[i]; }
+
+private:
+    T* first;
+    int sz;
+};
+
+// random access over the element indices of V; Check is a checking policy
+// (unchecked for the plain iterator). *it is a proxy, not a T&
+template<class V, class Ref, class Check>
+class soa_iterator {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_const<V>::type::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Ref reference;
+    typedef void pointer;
+
+    soa_iterator() : vec_obj(0), i(0) {}
+    soa_iterator(V* v, int index) throw(iterator_range_error) : vec_obj(v), i(index)
+    {
+        check_position(i,"soa_iterator(V*, int)");
+    }
+
+    // plain to const, checked to plain: both only widen what was already valid
+    template<class V2, class Ref2, class Check2,
+             class = typename std::enable_if<std::is_convertible<V2*,V*>::value>::type>
+    soa_iterator(const soa_iterator<V2,Ref2,Check2>& p) : vec_obj(p.container()), i(p.index()) {}
+
+    Ref operator*() const throw(iterator_range_error)
+    {
+        Check::check(0<=i && i<vec_obj->size(),"soa_iterator::operator*()"," not dereferenceable",i);
+        return (*vec_obj)[i];
+    }
+
+    Ref operator[](difference_type n) const throw(iterator_range_error)
+    {
+        Check::check(0<=i+n && i+n<vec_obj->size(),"soa_iterator::operator[]"," not dereferenceable",i,n);
+        return (*vec_obj)[int(i+n)];
+    }
+
+    soa_iterator& operator++() throw(iterator_range_error) { return *this += 1; }
+    soa_iterator& operator--() throw(iterator_range_error) { return *this -= 1; }
+    soa_iterator operator++(int) throw(iterator_range_error) { soa_iterator t(*this); *this += 1; return t; }
+    soa_iterator operator--(int) throw(iterator_range_error) { soa_iterator t(*this); *this -= 1; return t; }
+
+    soa_iterator& operator+=(difference_type n) throw(iterator_range_error)
+    {
+        check_position(i+n,"soa_iterator::operator+=(difference_type)",n);
+        i += int(n);
+        return *this;
+    }
+
+    soa_iterator& operator-=(difference_type n) throw(iterator_range_error) { return *this += -n; }
+    soa_iterator operator+(difference_type n) const throw(iterator_range_error) { soa_iterator t(*this); return t += n; }
+    soa_iterator operator-(difference_type n) const throw(iterator_range_error) { soa_iterator t(*this); return t += -n; }
+
+    template<class V2, class R2, class C2>
+    difference_type operator-(const soa_iterator<V2,R2,C2>& p) const { return i-p.index(); }
+
+    template<class V2, class R2, class C2>
+    bool operator==(const soa_iterator<V2,R2,C2>& p) const { return i==p.index() && vec_obj==p.container(); }
+    template<class V2, class R2, class C2>
+    bool operator!=(const soa_iterator<V2,R2,C2>& p) const { return !(*this==p); }
+    template<class V2, class R2, class C2>
+    bool operator<(const soa_iterator<V2,R2,C2>& p) const { return i<p.index(); }
+    template<class V2, class R2, class C2>
+    bool operator>(const soa_iterator<V2,R2,C2>& p) const { return i>p.index(); }
+    template<class V2, class R2, class C2>
+    bool operator<=(const soa_iterator<V2,R2,C2>& p) const { return i<=p.index(); }
+    template<class V2, class R2, class C2>
+    bool operator>=(const soa_iterator<V2,R2,C2>& p) const { return i>=p.index(); }
+
+    int index() const { return i; }
+    V* container() const { return vec_obj; }
+
+private:
+    void check_position(difference_type p, const char* s, difference_type offset = 0) const throw(iterator_range_error)
+    {
+        Check::check(p<=vec_obj->size(),s," passed end()",p-offset,offset);
+        Check::check(0<=p,s," before begin()",p-offset,offset);
+    }
+
+    V* vec_obj;
+    int i;
+};
+
+template<class... Fields>
+class soa_vector {
+    static_assert(sizeof...(Fields)>0,"soa_vector needs at least one field");
+    typedef std::index_sequence_for<Fields...> all_fields;
+
+public:
+    template<class T> using column_type = vector<T,aligned_allocator<T> >;
+    typedef std::tuple<Fields...> value_type;
+    typedef std::tuple<Fields&...> reference;          // proxies: assigning one writes every column
+    typedef std::tuple<const Fields&...> const_reference;
+    typedef VECTOR_CHECK_POLICY check_policy;
+    typedef soa_iterator<soa_vector,reference,unchecked> iterator;
+    typedef soa_iterator<const soa_vector,const_reference,unchecked> const_iterator;
+    typedef soa_iterator<soa_vector,reference,check_policy> checked_iterator;
+    typedef soa_iterator<const soa_vector,const_reference,check_policy> const_checked_iterator;
+    template<int I> using field_type = typename std::tuple_element<I,value_type>::type;
+
+    soa_vector() {}
+
+    explicit soa_vector(int n, const value_type& def = value_type()) { resize(n,def); }
+
+    reference operator[](int i) { return row(i,all_fields()); }
+    const_reference operator[](int i) const { return row(i,all_fields()); }
+
+    reference at(int n)
+    {
+        if(n<0 || size()<=n) throw Range_error(n);
+        return (*this)[n];
+    }
+
+    const_reference at(int n) const
+    {
+        if(n<0 || size()<=n) throw Range_error(n);
+        return (*this)[n];
+    }
+
+    int size() const { return std::get<0>(cols).size(); }
+    int capacity() const { return std::get<0>(cols).capacity(); }
+    bool empty() const { return size()==0; }
+
+    void reserve(int n) { reserve(n,all_fields()); }
+    void shrink_to_fit() { shrink_to_fit(all_fields()); }
+    void resize(int n, const value_type& def = value_type());
+
+    void push_back(const Fields&... f) { append(std::forward_as_tuple(f...)); }
+    void push_back(const value_type& t) { append(t); }
+    void push_back(value_type&& t) { append(std::move(t)); }
+    void pop_back() { pop_back(all_fields()); }
+
+    iterator begin() { return iterator(this,0); }
+    iterator end() { return iterator(this,size()); }
+    const_iterator begin() const { return const_iterator(this,0); }
+    const_iterator end() const { return const_iterator(this,size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    checked_iterator checked_begin() { return checked_iterator(this,0); }
+    checked_iterator checked_end() { return checked_iterator(this,size()); }
+    const_checked_iterator checked_cbegin() const { return const_checked_iterator(this,0); }
+    const_checked_iterator checked_cend() const { return const_checked_iterator(this,size()); }
+
+    iterator insert(const_iterator p, const value_type& t);
+    iterator erase(const_iterator p) { return erase(p,p+1); }
+    iterator erase(const_iterator first, const_iterator last);
+    void clear() { clear(all_fields()); }
+
+    void swap(soa_vector& v) { cols.swap(v.cols); }
+
+    // column I as one contiguous range, for loops the compiler can vectorize
+    template<int I>
+    column_span<field_type<I> > column()
+    {
+        column_type<field_type<I> >& c = std::get<I>(cols);
+        return column_span<field_type<I> >(c.begin(),c.size());
+    }
+
+    template<int I>
+    column_span<const field_type<I> > column() const
+    {
+        const column_type<field_type<I> >& c = std::get<I>(cols);
+        return column_span<const field_type<I> >(c.begin(),c.size());
+    }
+
+private:
+    template<std::size_t... I>
+    reference row(int i, std::index_sequence<I...>) { return reference(std::get<I>(cols)[i]...); }
+    template<std::size_t... I>
+    const_reference row(int i, std::index_sequence<I...>) const { return const_reference(std::get<I>(cols)[i]...); }
+
+    template<std::size_t... I>
+    void reserve(int n, std::index_sequence<I...>)
+    {
+        int expand[] = { (std::get<I>(cols).reserve(n),0)... };
+        (void)expand;
+    }
+
+    template<std::size_t... I>
+    void shrink_to_fit(std::index_sequence<I...>)
+    {
+        int expand[] = { (std::get<I>(cols).shrink_to_fit(),0)... };
+        (void)expand;
+    }
+
+    template<std::size_t... I>
+    void pop_back(std::index_sequence<I...>)
+    {
+        int expand[] = { (std::get<I>(cols).pop_back(),0)... };
+        (void)expand;
+    }
+
+    template<std::size_t... I>
+    void clear(std::index_sequence<I...>)
+    {
+        int expand[] = { (std::get<I>(cols).clear(),0)... };
+        (void)expand;
+    }
+
+    template<std::size_t... I>
+    void erase(int first, int last, std::index_sequence<I...>)
+    {
+        int expand[] = { (erase_rows(std::get<I>(cols),first,last),0)... };
+        (void)expand;
+    }
+
+    // vector's prefix erase would open a front gap, and the column would no
+    // longer start on its cache line: shift the tail down and drop the back
+    template<class Column>
+    static void erase_rows(Column& c, int first, int last)
+    {
+        if(first==0 && last<c.size()){
+            std::move(c.begin()+last,c.end(),c.begin());
+            c.erase(c.end()-last,c.end());
+        }
+        else c.erase(c.begin()+first,c.begin()+last);
+    }
+
+    // the columns grow together, so one push_back reallocates all of them or none
+    void make_room()
+    {
+        if(size()==capacity()) reserve(size()<8 ? 8 : 2*size());
+    }
+
+    template<class Tuple>
+    void append(Tuple&& t)
+    {
+        make_room();
+        append_from<0>(std::forward<Tuple>(t));
+    }
+
+    // column I onwards; a throwing constructor takes back what the earlier columns got
+    template<std::size_t I, class Tuple>
+    typename std::enable_if<I<sizeof...(Fields)>::type append_from(Tuple&& t)
+    {
+        std::get<I>(cols).push_back(std::get<I>(std::forward<Tuple>(t)));
+        try{
+            append_from<I+1>(std::forward<Tuple>(t));
+        }catch(...){
+            std::get<I>(cols).pop_back();
+            throw;
+        }
+    }
+
+    template<std::size_t I, class Tuple>
+    typename std::enable_if<I==sizeof...(Fields)>::type append_from(Tuple&&) {}
+
+    template<std::size_t I>
+    typename std::enable_if<I<sizeof...(Fields)>::type insert_from(int index, const value_type& t)
+    {
+        column_type<field_type<I> >& c = std::get<I>(cols);
+        const field_type<I>& f = std::get<I>(t);
+        c.insert(c.begin()+index,&f,&f+1);     // the range insert shifts; the single one would use the front gap at 0
+        try{
+            insert_from<I+1>(index,t);
+        }catch(...){
+            erase_rows(c,index,index+1);
+            throw;
+        }
+    }
+
+    template<std::size_t I>
+    typename std::enable_if<I==sizeof...(Fields)>::type insert_from(int, const value_type&) {}
+
+    std::tuple<column_type<Fields>...> cols;
+};
+
+template<class... Fields>
+void soa_vector<Fields...>::resize(int n, const value_type& def)
+{
+    if(n<0) return;
+    reserve(n);
+    while(n<size()) pop_back();
+    while(size()<n) append(def);
+}
+
+template<class... Fields>
+typename soa_vector<Fields...>::iterator soa_vector<Fields...>::insert(typename soa_vector<Fields...>::const_iterator p, const value_type& t)
+{
+    int index = p.index();
+    if(index==size()){
+        append(t);
+        return iterator(this,index);
+    }
+    make_room();
+    insert_from<0>(index,t);
+    return iterator(this,index);
+}
+
+template<class... Fields>
+typename soa_vector<Fields...>::iterator soa_vector<Fields...>::erase(typename soa_vector<Fields...>::const_iterator first,
+                                                                     typename soa_vector<Fields...>::const_iterator last)
+{
+    erase(first.index(),last.index(),all_fields());
+    return iterator(this,first.index());
+}
+
+template<class... Fields>
+void swap(soa_vector<Fields...>& a, soa_vector<Fields...>& b)
+{
+    a.swap(b);
+}
+
+#endif // SOA_VECTOR_H
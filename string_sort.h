@@ -0,0 +1,152 @@
+#ifndef STRING_SORT_H
+#define STRING_SORT_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include "vector.h"
+
+// multikey quicksort for std::string: the strings are never compared or moved
+// while sorting. a side array holds, for every string, its index and the next
+// 8 bytes of the key packed big endian into an integer, so partitioning is
+// plain integer compares over contiguous memory. only groups that tie on those
+// 8 bytes go back to the strings, for the following 8. the sorted index array
+// is then applied as a permutation, moving each string once
+
+namespace string_sort_detail {
+
+struct entry {
+    std::uint64_t key;      // bytes [depth, depth+8) of the string, zero padded
+    int index;
+};
+
+inline std::uint64_t key_at(const std::string& s, std::size_t depth)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data())+depth;
+    std::size_t left = s.size()-depth;
+    std::uint64_t k = 0;
+    if(8<=left){
+        std::memcpy(&k,p,8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        k = __builtin_bswap64(k);
+#endif
+        return k;
+    }
+    for(std::size_t i=0 ; i<left ; ++i) k |= std::uint64_t(p[i]) << (56-8*i);
+    return k;
+}
+
+// only for strings that agree on their first depth bytes
+inline bool tail_less(const std::string& a, const std::string& b, std::size_t depth)
+{
+    std::size_t la = a.size()-depth, lb = b.size()-depth;
+    int c = std::memcmp(a.data()+depth,b.data()+depth,std::min(la,lb));
+    return c<0 || (c==0 && la<lb);
+}
+
+inline void insertion_sort(entry* e, int n, const std::string* s, std::size_t depth)
+{
+    for(int i=1 ; i<n ; ++i){
+        entry x = e[i];
+        int j = i;
+        for( ; 0<j ; --j){
+            const entry& y = e[j-1];
+            if(y.key<x.key || (y.key==x.key && !tail_less(s[x.index],s[y.index],depth))) break;
+            e[j] = y;
+        }
+        e[j] = x;
+    }
+}
+
+inline std::uint64_t median3(std::uint64_t a, std::uint64_t b, std::uint64_t c)
+{
+    return a<b ? (b<c ? b : (a<c ? c : a)) : (a<c ? a : (b<c ? c : b));
+}
+
+// e[0..n) agree on their first depth bytes and carry the key at depth
+inline void multikey_sort(entry* e, int n, const std::string* s, std::size_t depth)
+{
+    while(1<n){
+        if(n<=16){
+            insertion_sort(e,n,s,depth);
+            return;
+        }
+        std::uint64_t pivot = median3(e[0].key,e[n/2].key,e[n-1].key);
+        int lt = 0, i = 0, gt = n;      // [0,lt) < pivot, [lt,i) == pivot, [gt,n) > pivot
+        while(i<gt){
+            if(e[i].key<pivot) std::swap(e[lt++],e[i++]);
+            else if(pivot<e[i].key) std::swap(e[i],e[--gt]);
+            else ++i;
+        }
+
+        // the equal group: strings that end within these 8 bytes are prefixes of
+        // the others, shortest first; the rest go on to the next 8 bytes
+        entry* mid = std::partition(e+lt,e+gt,[&](const entry& x){ return s[x.index].size()<=depth+8; });
+        std::sort(e+lt,mid,[&](const entry& a, const entry& b){ return s[a.index].size()<s[b.index].size(); });
+        for(entry* p=mid ; p!=e+gt ; ++p) p->key = key_at(s[p->index],depth+8);
+        multikey_sort(mid,int(e+gt-mid),s,depth+8);
+
+        // recurse into the smaller side, loop on the larger
+        if(lt<n-gt){
+            multikey_sort(e,lt,s,depth);
+            e += gt;
+            n -= gt;
+        }
+        else{
+            multikey_sort(e+gt,n-gt,s,depth);
+            n = lt;
+        }
+    }
+}
+
+}   // namespace string_sort_detail
+
+inline void string_sort(std::string* first, std::string* last)
+{
+    using namespace string_sort_detail;
+    int n = int(last-first);
+    if(n<2) return;
+    std::vector<entry> e(n);
+    for(int i=0 ; i<n ; ++i){
+        e[i].key = key_at(first[i],0);
+        e[i].index = i;
+    }
+    multikey_sort(&e[0],n,first,0);
+
+    // position i takes the string at e[i].index; follow each cycle once
+    for(int i=0 ; i<n ; ++i){
+        if(e[i].index==i) continue;
+        std::string tmp(std::move(first[i]));
+        int j = i;
+        for(;;){
+            int k = e[j].index;
+            e[j].index = j;
+            if(k==i){
+                first[j] = std::move(tmp);
+                break;
+            }
+            first[j] = std::move(first[k]);
+            j = k;
+        }
+    }
+}
+
+template<class A, class C, class G>
+void string_sort(vector<std::string,A,C,G>& v)
+{
+    string_sort(v.begin(),v.end());
+}
+
+namespace string_sort_detail {
+
+// what a sort without a comparator uses: string_sort for strings, std::sort otherwise
+template<class P>
+void default_sort(P first, P last) { std::sort(first,last); }
+
+inline void default_sort(std::string* first, std::string* last) { string_sort(first,last); }
+
+}   // namespace string_sort_detail
+
+#endif // STRING_SORT_H
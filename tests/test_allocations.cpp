@@ -0,0 +1,395 @@
+// allocation and copy budgets for vector's public operations, counted through
+// tracing_allocator: one allocation per growth, none for checked traversal,
+// none for a copy into a block that already fits, and existing elements are
+// moved, never copied. an operation that starts allocating or copying more
+// than its budget fails the test
+//
+//  usage: test_allocations     (exit status 0 when every budget holds)
+
+#include <iostream>
+#include <algorithm>
+#include "../vector.h"
+#include "../allocators.h"
+#include "../checked_range.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+// counts what the allocator can't see: assignments and temporaries. not
+// trivially copyable, so vector builds and moves it through the allocator
+struct counted {
+    static long copies;     // copy constructions and copy assignments
+    static long moves;
+
+    counted(int v = 0) : x(v) {}
+    counted(const counted& o) : x(o.x) { ++copies; }
+    counted(counted&& o) noexcept : x(o.x) { ++moves; }
+    counted& operator=(const counted& o) { x = o.x; ++copies; return *this; }
+    counted& operator=(counted&& o) noexcept { x = o.x; ++moves; return *this; }
+
+    bool operator==(const counted& o) const { return x==o.x; }
+    bool operator<(const counted& o) const { return x<o.x; }
+
+    int x;
+};
+
+long counted::copies = 0;
+long counted::moves = 0;
+
+typedef tracing_allocator<counted> traced;
+typedef vector<counted,traced,throw_on_error> cvec;
+typedef vector<int,tracing_allocator<int>,throw_on_error> ivec;
+typedef vector<int,tracing_allocator<int,malloc_allocator<int> >,throw_on_error> rvec;
+
+static void reset(alloc_trace& t)
+{
+    t.reset();
+    counted::copies = counted::moves = 0;
+}
+
+// blocks double_growth<> goes through to hold n elements, and the elements
+// carried from one block to the next on the way
+static int growths(int n)
+{
+    int k = 0;
+    for(int cap=0 ; cap<n ; cap=double_growth<>::grow(cap,cap+1,sizeof(int))) ++k;
+    return k;
+}
+
+static int relocations(int n)
+{
+    int moved = 0;
+    for(int cap=double_growth<>::grow(0,1,sizeof(int)) ; cap<n ; cap=double_growth<>::grow(cap,cap+1,sizeof(int))) moved += cap;
+    return moved;
+}
+
+static void fill(cvec& v, int n)
+{
+    for(int i=0 ; i<n ; ++i) v.push_back(counted(n-i));
+}
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+
+static void test_push_back()
+{
+    const int n = 1000;
+    alloc_trace t;
+    {
+        cvec v((traced(t)));
+        for(int i=0 ; i<n ; ++i) v.push_back(counted(i));
+        CHECK(t.allocations==growths(n));               // one allocation per growth
+        CHECK(t.deallocations==t.allocations-1);
+        CHECK(t.copy_constructs==0);                    // existing elements are moved, never copied
+        CHECK(counted::copies==0);
+        CHECK(t.move_constructs<=n+relocations(n));     // the new element, plus each relocation once
+
+        reset(t);
+        counted c(7);
+        for(int i=0 ; i<n ; ++i) v.push_back(c);
+        CHECK(t.allocations==1);
+        CHECK(t.copy_constructs==n);                    // the pushed values and nothing else
+        CHECK(counted::copies==n);
+    }
+    CHECK(t.live_bytes==0);
+}
+
+static void test_reserve()
+{
+    const int n = 1000;
+    alloc_trace t;
+    reset(t);
+    cvec v((traced(t)));
+    v.reserve(n);
+    for(int i=0 ; i<n ; ++i) v.push_back(counted(i));
+    CHECK(t.allocations==1);
+    CHECK(t.bytes_allocated==long(n*sizeof(counted)));
+    CHECK(t.move_constructs==n);
+    CHECK(counted::copies==0);
+}
+
+static void test_push_front()
+{
+    const int n = 1000;
+    alloc_trace t;
+    reset(t);
+    cvec v((traced(t)));
+    for(int i=0 ; i<n ; ++i) v.push_front(counted(i));
+    CHECK(t.allocations<=growths(n)+1);                 // the front gap doubles like the back does
+    CHECK(counted::copies==0);
+    CHECK(v.front().x==n-1 && v.back().x==0);
+}
+
+static void test_insert_erase()
+{
+    const int n = 100;
+    alloc_trace t;
+    cvec v((traced(t)));
+    v.reserve(2*n);
+    fill(v,n);
+
+    reset(t);
+    v.insert(v.begin()+n/2,counted(-1));
+    CHECK(t.allocations==0);
+    CHECK(counted::copies==0);
+
+    reset(t);
+    counted c(-2);
+    v.insert(v.begin()+n/3,c);
+    CHECK(t.allocations==0);
+    CHECK(counted::copies<=1);                          // the inserted value
+
+    reset(t);
+    v.erase(v.begin()+n/4);
+    v.erase(v.begin()+10,v.begin()+20);
+    CHECK(t.allocations==0 && t.deallocations==0);
+    CHECK(counted::copies==0);
+
+    // a block that is full: one new block, prefix and tail relocated once each
+    cvec w((traced(t)));
+    fill(w,n);
+    w.shrink_to_fit();
+    cvec more((traced(t)));
+    fill(more,n/2);
+    reset(t);
+    w.insert(w.begin()+n/2,more.begin(),more.end());
+    CHECK(t.allocations==1);
+    CHECK(t.copy_constructs==n/2);
+    CHECK(t.move_constructs==n);
+    CHECK(counted::copies==n/2);
+}
+
+static void test_checked_traversal()
+{
+    const int n = 1000;
+    alloc_trace t;
+    cvec v((traced(t)));
+    fill(v,n);
+
+    reset(t);
+    long sum = 0;
+    for(cvec::checked_iterator i=v.checked_begin() ; i!=v.checked_end() ; ++i) sum += i->x;
+    for(cvec::checked_iterator i=v.checked_end() ; i!=v.checked_begin() ; ) sum -= (--i)->x;
+    CHECK(sum==0);
+    CHECK(std::find(v.checked_begin(),v.checked_end(),counted(1))!=v.checked_end());
+    checked_range<cvec::checked_iterator> r = make_checked_range(v);
+    CHECK(find(r,counted(n))==r.begin());
+    CHECK(t.allocations==0 && t.constructs==0);
+    CHECK(counted::copies==0 && counted::moves==0);
+
+    std::sort(v.checked_begin(),v.checked_end());
+    sort(make_checked_range(v));
+    CHECK(t.allocations==0);
+    CHECK(counted::copies==0);                          // sorting moves
+}
+
+static void test_copy()
+{
+    const int n = 500;
+    alloc_trace t;
+    cvec v((traced(t)));
+    fill(v,n);
+
+    reset(t);
+    cvec w(v);
+    CHECK(t.allocations==1);
+    CHECK(t.bytes_allocated==long(n*sizeof(counted)));
+    CHECK(t.copy_constructs==n && counted::copies==n);
+
+    cvec big((traced(t)));
+    big.reserve(2*n);
+    fill(big,n/2);
+    reset(t);
+    big = v;                                            // fits: no allocation, one copy per element
+    CHECK(t.allocations==0 && t.deallocations==0);
+    CHECK(counted::copies==n);
+    reset(t);
+    big = v;
+    CHECK(t.allocations==0 && counted::copies==n);
+
+    cvec small((traced(t)));
+    fill(small,n/4);
+    reset(t);
+    small = v;                                          // doesn't fit: exactly one new block
+    CHECK(t.allocations==1 && t.deallocations==1);
+    CHECK(counted::copies==n);
+
+    reset(t);
+    big.assign(n,counted(3));
+    CHECK(t.allocations==0);
+    CHECK(counted::copies<=n+1);                        // one for the value, which may be ours
+
+    reset(t);
+    small.assign_strong(v);
+    CHECK(t.allocations==1 && counted::copies==n);
+}
+
+static void test_move_swap()
+{
+    const int n = 500;
+    alloc_trace t;
+    cvec v((traced(t)));
+    fill(v,n);
+
+    reset(t);
+    cvec w(std::move(v));
+    CHECK(t.allocations==0 && t.constructs==0);
+    CHECK(counted::copies==0 && counted::moves==0);
+
+    cvec u((traced(t)));
+    reset(t);
+    u = std::move(w);                                   // same trace, equal allocators: the block changes hands
+    CHECK(t.allocations==0 && t.constructs==0);
+    CHECK(counted::copies==0 && counted::moves==0);
+
+    reset(t);
+    u.swap(w);
+    CHECK(t.allocations==0 && t.constructs==0);
+    CHECK(counted::copies==0 && counted::moves==0);
+}
+
+// a FIFO: push_back at one end, erase(begin()) at the other. the front gap
+// left behind must be taken back, not carried from block to block
+static void test_fifo()
+{
+    const int n = 100000;
+    const int depth = 100;
+    alloc_trace t;
+    cvec v((traced(t)));
+    for(int i=0 ; i<n ; ++i){
+        v.push_back(counted(i));
+        v.erase(v.begin());
+    }
+    CHECK(v.size()==0 && v.front_capacity()==0);
+    CHECK(t.allocations==1);
+
+    // the block grows until the gap can outgrow depth elements, then is reused
+    for(int i=0 ; i<depth ; ++i) v.push_back(counted(i));
+    for(int round=0 ; round<2 ; ++round){
+        reset(t);
+        for(int i=0 ; i<n ; ++i){
+            v.push_back(counted(i));
+            v.erase(v.begin());
+        }
+        CHECK(t.allocations<=(round==0 ? 2 : 0));
+    }
+    CHECK(v.front_capacity()<=v.capacity()+depth);
+    CHECK(counted::copies==0);
+}
+
+static void test_resize_clear_shrink()
+{
+    const int n = 500;
+    alloc_trace t;
+    cvec v((traced(t)));
+    v.reserve(n);
+    fill(v,n/2);
+
+    reset(t);
+    v.resize(n);
+    v.resize(n/4);
+    CHECK(t.allocations==0);
+    CHECK(t.destroys==n-n/4);
+
+    reset(t);
+    v.clear();
+    CHECK(t.deallocations==0);                          // the block is kept for the next fill
+    CHECK(v.capacity()==n && v.front_capacity()==0);
+    fill(v,n);                                          // all of it, not what is left past a front gap
+    CHECK(t.allocations==0);
+
+    // a scratch buffer: cleared and refilled over and over, from a block
+    // that growth left with some slack
+    cvec w((traced(t)));
+    fill(w,2*n);
+    reset(t);
+    for(int round=0 ; round<50 ; ++round){
+        w.clear();
+        w.reserve(n/5);
+        fill(w,2*n);
+    }
+    CHECK(t.allocations==0 && t.deallocations==0);
+    CHECK(w.front_capacity()==0);
+
+    reset(t);
+    v.resize(n/2);
+    v.shrink_to_fit();
+    CHECK(t.allocations==1 && t.deallocations==1);
+    CHECK(counted::copies==0);
+}
+
+// the first block can be sized per vector, not only per growth policy type
+static void test_initial_capacity()
+{
+    const int n = 100;
+    alloc_trace t;
+    cvec v((traced(t)));
+    v.set_initial_capacity(n);
+    CHECK(v.initial_capacity()==n && v.capacity()==0);
+    reset(t);
+    fill(v,n);
+    CHECK(t.allocations==1 && v.capacity()==n);     // one block for all of them
+    v.push_back(counted(0));
+    CHECK(v.capacity()==2*n);                       // then G's growth as usual
+
+    cvec w(v);                                      // the setting stays with v
+    CHECK(w.initial_capacity()==double_growth<>::grow(0,1,sizeof(counted)));
+    v.clear();
+    v.shrink_to_fit();
+    reset(t);
+    v.push_back(counted(1));
+    CHECK(t.allocations==1 && v.capacity()==n);     // and counts again once v has no block
+    v.set_initial_capacity(0);
+    CHECK(v.initial_capacity()==8);
+}
+
+// trivially relocatable elements never reach construct when they move:
+// memcpy with std::allocator, A::reallocate when the allocator has one
+static void test_relocatable()
+{
+    const int n = 100000;
+    alloc_trace t;
+    {
+        ivec v((tracing_allocator<int>(t)));
+        for(int i=0 ; i<n ; ++i) v.push_back(i);
+        CHECK(t.allocations==growths(n));
+        CHECK(t.reallocations==0);
+        CHECK(t.constructs==n);                         // the pushed ints only
+    }
+    CHECK(t.live_bytes==0);
+
+    reset(t);
+    {
+        rvec v((tracing_allocator<int,malloc_allocator<int> >(t)));
+        for(int i=0 ; i<n ; ++i) v.push_back(i);
+        CHECK(t.allocations==1);                        // the first block, then realloc
+        CHECK(t.reallocations==growths(n)-1);
+        CHECK(t.deallocations==0);
+        CHECK(t.constructs==n);
+        CHECK(t.live_bytes==long(v.capacity()*sizeof(int)));
+    }
+    CHECK(t.live_bytes==0);
+}
+
+int main()
+{
+    test_push_back();
+    test_reserve();
+    test_push_front();
+    test_insert_erase();
+    test_checked_traversal();
+    test_copy();
+    test_move_swap();
+    test_fifo();
+    test_resize_clear_shrink();
+    test_initial_capacity();
+    test_relocatable();
+
+    if(failures){
+        std::cerr << failures << " allocation budget(s) broken\n";
+        return 1;
+    }
+    std::cout << "every allocation budget holds\n";
+    return 0;
+}
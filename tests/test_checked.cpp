@@ -0,0 +1,72 @@
+// checked iterators and block generations: an iterator made before its
+// vector's elements moved is reported when used after, and under unchecked
+// the checked iterators cost nothing, down to their size
+//
+//  usage: test_checked     (exit status 0 when every check holds)
+
+#include <iostream>
+#include "../vector.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+typedef vector<int,std::allocator<int>,throw_on_error> cvec;
+typedef vector<int,std::allocator<int>,unchecked> uvec;
+
+static_assert(sizeof(uvec::checked_iterator)==2*sizeof(int*) && sizeof(uvec::const_checked_iterator)==2*sizeof(int*),
+              "an unchecked checked_iterator carries no generation stamp");
+
+template<class It>
+static bool stale(It i)
+{
+    try{
+        (void)*i;
+    }catch(iterator_range_error&){
+        return true;
+    }
+    return false;
+}
+
+static void test_generations()
+{
+    cvec v;
+    v.reserve(4);
+    for(int i=0 ; i<4 ; ++i) v.push_back(i);
+    cvec::checked_iterator p = v.checked_begin();
+    cvec::const_checked_iterator q = p;
+    CHECK(!stale(p) && !stale(q) && q.generation()==v.generation());
+
+    v[0] = 7;                                       // no element moves
+    CHECK(!stale(p) && *p==7);
+
+    v.push_back(4);                                 // a new block
+    CHECK(stale(p) && stale(q));
+
+    cvec::checked_iterator r = v.checked_begin();
+    CHECK(!stale(r) && *r==7);
+    v.erase(v.begin());                             // begin() steps into a front gap, nothing moves
+    CHECK(!stale(r+1) && *(r+1)==1);
+    v.shrink_to_fit();                              // the rest go to a block of their own
+    CHECK(stale(r));
+    r = v.checked_begin();
+
+    cvec w;
+    w.push_back(9);
+    cvec::checked_iterator s = w.checked_begin();
+    v.swap(w);                                      // both sides' iterators are stale
+    CHECK(stale(r) && stale(s));
+}
+
+int main()
+{
+    test_generations();
+
+    if(failures){
+        std::cerr << failures << " checked iterator check(s) failed\n";
+        return 1;
+    }
+    std::cout << "every checked iterator check holds\n";
+    return 0;
+}
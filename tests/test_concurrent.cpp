@@ -0,0 +1,193 @@
+// concurrent_vector under several writers and a reader, with element
+// constructors and segment allocations that fail now and then. a push_back
+// that throws leaves a hole: size() still moves past it, nothing is invented
+// in its place, and every element that was pushed is where push_back said
+//
+//  usage: test_concurrent      (exit status 0 when every check holds)
+
+#include <iostream>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../concurrent_vector.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+// no default constructor, and one in every 61 values refuses to be built
+struct tracked {
+    static std::atomic<int> live;
+
+    explicit tracked(int v) : x(v), check(~v)
+    {
+        if(v%61==0) throw std::runtime_error("refused");
+        ++live;
+    }
+    tracked(const tracked& o) : x(o.x), check(o.check) { ++live; }
+    ~tracked() { --live; }
+
+    bool whole() const { return check==~x; }
+
+    int x;
+    int check;
+};
+
+std::atomic<int> tracked::live(0);
+
+// std::allocator, except that the allocations fail_at[] names throw bad_alloc
+struct flaky_state {
+    std::atomic<int> calls;
+    std::atomic<long> live_bytes;
+    int fail_at[3];
+};
+
+template<class T>
+struct flaky_allocator {
+    typedef T value_type;
+
+    explicit flaky_allocator(flaky_state& s) : state(&s) {}
+    template<class U> flaky_allocator(const flaky_allocator<U>& o) : state(o.state) {}
+
+    T* allocate(std::size_t n)
+    {
+        int call = state->calls++;
+        for(int f : state->fail_at)
+            if(call==f) throw std::bad_alloc();
+        state->live_bytes += long(n*sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        state->live_bytes -= long(n*sizeof(T));
+        std::allocator<T>().deallocate(p,n);
+    }
+
+    flaky_state* state;
+};
+
+template<class T, class U>
+bool operator==(const flaky_allocator<T>& a, const flaky_allocator<U>& b) { return a.state==b.state; }
+template<class T, class U>
+bool operator!=(const flaky_allocator<T>& a, const flaky_allocator<U>& b) { return !(a==b); }
+
+typedef concurrent_vector<tracked,flaky_allocator<tracked>,throw_on_error> cvec;
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+
+static void test_writers_and_reader()
+{
+    const int threads = 4;
+    const int n = 20000;
+    flaky_state state;
+    state.calls = 0;
+    state.live_bytes = 0;
+    state.fail_at[0] = 2;       // the 3rd, 6th and 8th segment allocations fail,
+    state.fail_at[1] = 5;       // for whichever slots asked for them
+    state.fail_at[2] = 7;
+    {
+        cvec v((flaky_allocator<tracked>(state)));
+        std::vector<std::vector<int> > where(threads,std::vector<int>(n,-1));
+        std::atomic<int> thrown(0);
+        std::atomic<bool> done(false);
+        std::atomic<int> torn(0);
+
+        std::thread reader([&]{
+            while(!done.load()){
+                int size = v.size();
+                for(int i=0 ; i<size ; ++i)
+                    if(!v.is_hole(i) && !v[i].whole()) ++torn;
+            }
+        });
+        std::vector<std::thread> writers;
+        for(int t=0 ; t<threads ; ++t)
+            writers.push_back(std::thread([&,t]{
+                for(int k=0 ; k<n ; ++k){
+                    try{
+                        where[t][k] = v.emplace_back(t*n+k);
+                    }catch(std::runtime_error&){
+                        ++thrown;
+                    }catch(std::bad_alloc&){
+                        ++thrown;
+                    }
+                }
+            }));
+        for(int t=0 ; t<threads ; ++t) writers[t].join();
+        done = true;
+        reader.join();
+
+        CHECK(torn==0);
+        CHECK(v.size()==threads*n);                 // every slot settled, holes included
+        int holes = 0;
+        for(int i=0 ; i<v.size() ; ++i) holes += v.is_hole(i);
+        CHECK(holes==thrown);
+        CHECK(tracked::live==threads*n-holes);      // nothing constructed in a hole
+
+        int pushed = 0;
+        for(int t=0 ; t<threads ; ++t)
+            for(int k=0 ; k<n ; ++k){
+                int i = where[t][k];
+                if(i<0) continue;
+                ++pushed;
+                CHECK(!v.is_hole(i) && v[i].x==t*n+k);
+            }
+        CHECK(pushed+holes==threads*n);
+
+        int hole = 0;
+        while(!v.is_hole(hole)) ++hole;
+        bool at_threw = false;
+        try{ v.at(hole); }catch(Range_error&){ at_threw = true; }
+        CHECK(at_threw);
+        bool deref_threw = false;
+        try{ (void)v.checked_begin()[hole].x; }catch(iterator_range_error&){ deref_threw = true; }
+        CHECK(deref_threw);
+    }
+    CHECK(tracked::live==0);
+    CHECK(state.live_bytes==0);
+}
+
+// grow_by: a segment that can't be allocated leaves the whole run a hole,
+// and the vector carries on after it
+static void test_grow_by()
+{
+    flaky_state state;
+    state.calls = 0;
+    state.live_bytes = 0;
+    state.fail_at[0] = 1;
+    state.fail_at[1] = state.fail_at[2] = -1;
+    {
+        cvec v((flaky_allocator<tracked>(state)));
+        CHECK(v.grow_by(10,tracked(1))==0);
+        bool threw = false;
+        try{
+            v.grow_by(100,tracked(2));              // runs into segment 1, which can't be had
+        }catch(std::bad_alloc&){
+            threw = true;
+        }
+        CHECK(threw && v.size()==110);
+        CHECK(v.grow_by(5,tracked(3))==110);
+        CHECK(v.size()==115 && tracked::live==15);
+        for(int i=10 ; i<110 ; ++i) CHECK(v.is_hole(i));
+        CHECK(!v.is_hole(9) && !v.is_hole(110) && v[114].x==3);
+    }
+    CHECK(tracked::live==0);
+    CHECK(state.live_bytes==0);
+}
+
+int main()
+{
+    test_writers_and_reader();
+    test_grow_by();
+
+    if(failures){
+        std::cerr << failures << " concurrent_vector check(s) failed\n";
+        return 1;
+    }
+    std::cout << "every concurrent_vector check holds\n";
+    return 0;
+}
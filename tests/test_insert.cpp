@@ -0,0 +1,118 @@
+// single-element insert against std::vector, for an element type that is
+// not trivially relocatable (std::string): every size, every position,
+// rvalues, lvalues and values that live in the vector itself. then
+// push_back, emplace_back, push_front and insert of the vector's own
+// elements into a full block, which must copy them before the block goes
+//
+//  usage: test_insert      (exit status 0 when vector agrees with std::vector)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../vector.h"
+#include "../allocators.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+// long enough that a moved-from string is visibly empty
+static std::string name(int i)
+{
+    return "element number " + std::to_string(i) + " of the test";
+}
+
+template<class V, class T>
+static bool same(const V& v, const std::vector<T>& ref)
+{
+    if(v.size()!=int(ref.size())) return false;
+    for(int i=0 ; i<v.size() ; ++i)
+        if(v[i]!=ref[i]) return false;
+    return true;
+}
+
+static void test_insert(int n, int p)
+{
+    vector<std::string> v;
+    std::vector<std::string> ref;
+    v.reserve(n+3);     // no reallocation: the shift is what's under test
+    for(int i=0 ; i<n ; ++i){
+        v.push_back(name(i));
+        ref.push_back(name(i));
+    }
+
+    v.insert(v.begin()+p,name(-1));                         // rvalue
+    ref.insert(ref.begin()+p,name(-1));
+    CHECK(same(v,ref));
+
+    std::string x = name(-2);
+    v.insert(v.begin()+p,x);                                // lvalue
+    ref.insert(ref.begin()+p,x);
+    CHECK(same(v,ref));
+
+    v.insert(v.begin()+p,v[v.size()-1]);                    // one of its own, from the tail
+    ref.insert(ref.begin()+p,std::string(ref.back()));
+    CHECK(same(v,ref));
+}
+
+template<class T> T value(int i);
+template<> std::string value<std::string>(int i) { return name(i); }
+template<> int value<int>(int i) { return i; }
+
+// every call below finds the block full, so it reallocates with its argument
+// pointing into the block it is about to leave
+template<class V>
+static void test_own_elements(int n)
+{
+    typedef typename V::value_type T;
+    V v;
+    std::vector<T> ref;
+    for(int i=0 ; i<n ; ++i){
+        v.push_back(value<T>(i));
+        ref.push_back(value<T>(i));
+    }
+
+    v.shrink_to_fit();
+    v.push_back(v[0]);
+    ref.push_back(T(ref[0]));
+    CHECK(same(v,ref));
+
+    v.shrink_to_fit();
+    v.emplace_back(v.back());
+    ref.emplace_back(T(ref.back()));
+    CHECK(same(v,ref));
+
+    v.shrink_to_fit();
+    v.push_back(std::move(v[n/2]));
+    ref.push_back(std::move(ref[n/2]));
+    CHECK(same(v,ref));
+
+    v.shrink_to_fit();
+    v.push_front(v.back());
+    ref.insert(ref.begin(),T(ref.back()));
+    CHECK(same(v,ref));
+
+    v.shrink_to_fit();
+    v.insert(v.begin()+v.size()/2,v[v.size()-1]);
+    ref.insert(ref.begin()+ref.size()/2,T(ref.back()));
+    CHECK(same(v,ref));
+}
+
+int main()
+{
+    for(int n=0 ; n<40 ; ++n)
+        for(int p=0 ; p<=n ; ++p) test_insert(n,p);
+
+    for(int n=1 ; n<40 ; ++n){
+        test_own_elements<vector<std::string> >(n);
+        test_own_elements<vector<int,malloc_allocator<int> > >(n);      // grows through realloc
+    }
+
+    if(failures){
+        std::cerr << failures << " insert(s) disagree with std::vector\n";
+        return 1;
+    }
+    std::cout << "every insert agrees with std::vector\n";
+    return 0;
+}
@@ -0,0 +1,171 @@
+// mapped_vector keeps its elements in its file across reopening, through
+// erase, shrink_to_fit, clear and moves, and mapped_vector and mapped_view
+// refuse files they didn't write, or whose counts don't fit, untouched
+//
+//  usage: test_mapped_vector   (exit status 0 when every check holds)
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <sys/stat.h>
+#include "../mapped_vector.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+typedef mapped_vector<int,throw_on_error> mvec;
+typedef mapped_vector<double,throw_on_error> dvec;
+
+static const char* path = "test_mapped_vector.bin";
+
+static long file_size()
+{
+    struct stat st;
+    return ::stat(path,&st)==0 ? long(st.st_size) : -1;
+}
+
+static bool holds(const mvec& v, int first, int n)
+{
+    if(v.size()!=n) return false;
+    for(int i=0 ; i<n ; ++i)
+        if(v[i]!=first+i) return false;
+    return true;
+}
+
+template<class V>
+static bool refused()
+{
+    try{
+        V v(path);
+    }catch(std::runtime_error&){
+        return true;
+    }
+    return false;
+}
+
+// rewrites the header field at offset
+static void poke(std::size_t offset, std::uint64_t value)
+{
+    std::FILE* f = std::fopen(path,"r+b");
+    std::fseek(f,long(offset),SEEK_SET);
+    std::fwrite(&value,sizeof(value),1,f);
+    std::fclose(f);
+}
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+
+static void test_reopen()
+{
+    std::remove(path);
+    {
+        mvec v(path);
+        CHECK(v.size()==0);
+        for(int i=0 ; i<1000 ; ++i) v.push_back(i);
+    }
+    CHECK(file_size()>=long(mapped_file::header_size+1000*sizeof(int)));
+    {
+        mvec v(path);
+        CHECK(holds(v,0,1000));
+        for(int i=1000 ; i<5000 ; ++i) v.push_back(i);
+    }
+    mapped_view<int> view(path);
+    CHECK(view.size()==5000 && view[0]==0 && view[4999]==4999);
+}
+
+static void test_erase_shrink_clear()
+{
+    {
+        mvec v(path);
+        v.erase(v.begin(),v.begin()+1000);          // leaves a front gap, in the file
+    }
+    {
+        mvec v(path);
+        CHECK(holds(v,1000,4000) && v.front_capacity()==1000);
+        v.erase(v.begin()+2000,v.end());
+        v.shrink_to_fit();                          // still the file's block, just smaller
+        CHECK(holds(v,1000,2000) && v.front_capacity()==0 && v.capacity()==2000);
+    }
+    CHECK(file_size()==long(mapped_file::header_size+2000*sizeof(int)));
+    {
+        mvec v(path);
+        CHECK(holds(v,1000,2000));
+        v.clear();
+    }
+    {
+        mvec v(path);
+        CHECK(v.size()==0 && v.capacity()==2000);   // the block stays for the next fill
+        for(int i=0 ; i<10 ; ++i) v.push_back(i);
+    }
+    mvec v(path);
+    CHECK(holds(v,0,10));
+}
+
+static void test_move()
+{
+    {
+        mvec v(path);
+        mvec w(std::move(v));                       // the file goes with the elements
+        CHECK(holds(w,0,10) && v.size()==0);
+        w.push_back(10);
+    }
+    mvec v(path);
+    CHECK(holds(v,0,11));
+}
+
+static void test_refused()
+{
+    {
+        std::FILE* f = std::fopen(path,"wb");       // someone else's file, zeros up front
+        char zeros[200] = {};
+        std::fwrite(zeros,1,sizeof(zeros),f);
+        std::fputs("not ours",f);
+        std::fclose(f);
+    }
+    long before = file_size();
+    CHECK(refused<mvec>() && refused<mapped_view<int> >());
+    CHECK(file_size()==before);                     // not reinitialized, not truncated
+
+    std::remove(path);
+    std::uint64_t capacity;
+    {
+        mvec v(path);
+        for(int i=0 ; i<100 ; ++i) v.push_back(i);
+        capacity = v.capacity();
+    }
+    CHECK(refused<dvec>());                         // elements of another type
+
+    poke(offsetof(mapped_file::header,size),capacity+1);    // more elements than capacity
+    CHECK(refused<mvec>() && refused<mapped_view<int> >());
+    poke(offsetof(mapped_file::header,size),100);
+    poke(offsetof(mapped_file::header,capacity),std::uint64_t(1)<<40);
+    CHECK(refused<mvec>() && refused<mapped_view<int> >());
+    poke(offsetof(mapped_file::header,capacity),1000000);   // an int, but past the end of the file
+    CHECK(refused<mvec>());
+    poke(offsetof(mapped_file::header,capacity),capacity);
+    poke(offsetof(mapped_file::header,head),std::uint64_t(INT_MAX));
+    CHECK(refused<mvec>());
+    poke(offsetof(mapped_file::header,head),0);
+    mvec v(path);
+    CHECK(holds(v,0,100));
+}
+
+int main()
+{
+    test_reopen();
+    test_erase_shrink_clear();
+    test_move();
+    test_refused();
+    std::remove(path);
+
+    if(failures){
+        std::cerr << failures << " mapped_vector check(s) failed\n";
+        return 1;
+    }
+    std::cout << "every mapped_vector check holds\n";
+    return 0;
+}
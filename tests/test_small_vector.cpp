@@ -0,0 +1,106 @@
+// small_vector's slots stay with the small_vector: a vector moved out of one
+// (through a vector& to its base) takes the elements, not the slots, a swap
+// through the base exchanges the elements, and shrink_to_fit brings elements
+// that fit back into the slots
+//
+//  usage: test_small_vector    (exit status 0 when every check holds)
+
+#include <iostream>
+#include <string>
+#include "../small_vector.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+typedef small_vector<std::string,8> svec;
+typedef vector<std::string,inline_allocator<std::string,8> > base;
+
+static std::string name(int i)
+{
+    return "element number " + std::to_string(i) + " of the test";
+}
+
+static void test_sliced_move()
+{
+    svec s;
+    for(int i=0 ; i<5 ; ++i) s.push_back(name(i));
+    base b(std::move(static_cast<base&>(s)));       // the elements move, the slots stay
+    CHECK(b.size()==5 && s.size()==0);
+    CHECK(b.get_allocator().buf==0);
+    s.push_back(name(-1));                          // reuses the slots b must not be in
+    s.push_back(name(-2));
+    for(int i=0 ; i<5 ; ++i) CHECK(b[i]==name(i));
+    for(int i=0 ; i<20 ; ++i) b.push_back(name(i));
+    CHECK(s.size()==2 && s[0]==name(-1) && s[1]==name(-2));
+
+    svec h;
+    for(int i=0 ; i<20 ; ++i) h.push_back(name(i));
+    std::string* block = &h[0];
+    base c(std::move(static_cast<base&>(h)));       // a heap block is handed over
+    CHECK(c.size()==20 && &c[0]==block && h.size()==0);
+}
+
+// swapping through base references exchanges the elements, never the slots
+static void test_sliced_swap()
+{
+    svec a, b;
+    for(int i=0 ; i<3 ; ++i) a.push_back(name(i));
+    for(int i=0 ; i<20 ; ++i) b.push_back(name(100+i));
+    base& ba = a;
+    base& bb = b;
+    ba.swap(bb);                                    // inline with heap
+    CHECK(a.size()==20 && a[19]==name(119) && b.size()==3 && b[2]==name(2));
+    CHECK(b.is_inline());
+    swap(ba,bb);                                    // and back, through the free swap
+    CHECK(a.size()==3 && a[0]==name(0));
+    CHECK(b.size()==20 && b[0]==name(100));
+
+    svec c, d;
+    for(int i=0 ; i<2 ; ++i) c.push_back(name(i));
+    for(int i=0 ; i<5 ; ++i) d.push_back(name(10+i));
+    base& bc = c;
+    base& bd = d;
+    bc.swap(bd);                                    // both inline
+    CHECK(c.is_inline() && d.is_inline());
+    CHECK(c.size()==5 && c[4]==name(14) && d.size()==2 && d[1]==name(1));
+    for(int i=0 ; i<10 ; ++i) c.push_back(name(i));     // each grows out of its own slots
+    CHECK(d.size()==2 && d[0]==name(0));
+}
+
+static void test_shrink_to_fit()
+{
+    svec s;
+    for(int i=0 ; i<8 ; ++i) s.push_back(name(i));
+    s.erase(s.begin(),s.begin()+3);
+    CHECK(s.is_inline() && s.front_capacity()==3);
+    s.shrink_to_fit();                              // the front gap goes, the slots stay
+    CHECK(s.is_inline() && s.front_capacity()==0 && s.capacity()==8);
+    CHECK(s.size()==5 && s[0]==name(3) && s[4]==name(7));
+
+    for(int i=0 ; i<30 ; ++i) s.push_back(name(i));
+    CHECK(!s.is_inline());
+    s.erase(s.begin()+4,s.end());
+    s.shrink_to_fit();                              // fits again: back into the slots
+    CHECK(s.is_inline() && s.capacity()==8);
+    CHECK(s.size()==4 && s[3]==name(6));
+
+    for(int i=0 ; i<20 ; ++i) s.push_back(name(i));
+    s.shrink_to_fit();                              // too many: shrunk on the heap
+    CHECK(!s.is_inline() && s.capacity()==24);
+}
+
+int main()
+{
+    test_sliced_move();
+    test_sliced_swap();
+    test_shrink_to_fit();
+
+    if(failures){
+        std::cerr << failures << " small_vector check(s) failed\n";
+        return 1;
+    }
+    std::cout << "every small_vector check holds\n";
+    return 0;
+}
@@ -0,0 +1,130 @@
+// snapshot files are checked before they are trusted: a header whose element
+// count doesn't fit its payload is rejected, not used to size the vector, and
+// save replaces a snapshot whole or not at all
+//
+//  usage: test_snapshot    (exit status 0 when every check holds)
+
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include "../vector.h"
+#include "../snapshot.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do{ if(!(cond)){ ++failures; std::cerr << __FILE__ << ':' << __LINE__ << ": " << #cond << '\n'; } }while(0)
+
+// rewrites the count field of the snapshot at path
+static void set_count(const char* path, std::uint64_t count)
+{
+    std::FILE* f = std::fopen(path,"r+b");
+    std::fseek(f,offsetof(snapshot_header,count),SEEK_SET);
+    std::fwrite(&count,sizeof(count),1,f);
+    std::fclose(f);
+}
+
+template<class V>
+static bool rejected(const char* path, V& v)
+{
+    try{
+        load_snapshot(path,v);
+    }catch(std::runtime_error&){
+        return true;
+    }
+    return false;
+}
+
+static void test_round_trip(const char* path)
+{
+    vector<long> v;
+    for(int i=0 ; i<1000 ; ++i) v.push_back(long(i)*7);
+    save_snapshot(path,v);
+    vector<long> w;
+    load_snapshot(path,w);
+    CHECK(w.size()==1000 && w[999]==999*7);
+
+    vector<std::string> s;
+    for(int i=0 ; i<100 ; ++i) s.push_back(std::string(i%7,'a'+i%26));
+    save_snapshot(path,s);
+    vector<std::string> t;
+    load_snapshot(path,t);
+    CHECK(t.size()==100 && t[99]==s[99]);
+    CHECK(::access((std::string(path)+".tmp").c_str(),F_OK)!=0);    // renamed, not left behind
+}
+
+// strings go out a length and a data piece each, in batches of iovecs: many
+// more of them than one writev takes, empty ones included
+static void test_many_strings(const char* path)
+{
+    vector<std::string> s;
+    for(int i=0 ; i<5000 ; ++i) s.push_back(std::string(i%41,char('a'+i%26)));
+    save_snapshot(path,s);
+    vector<std::string> t;
+    load_snapshot(path,t);          // checksum verified
+    CHECK(t.size()==5000);
+    bool same = true;
+    for(int i=0 ; i<5000 ; ++i) same = same && t[i]==s[i];
+    CHECK(same);
+}
+
+// a save that fails leaves the snapshot already at path as it was
+static void test_failed_save(const char* path)
+{
+    vector<int> v(100,1);
+    save_snapshot(path,v);
+    std::string tmp = std::string(path)+".tmp";
+    ::mkdir(tmp.c_str(),0755);          // path.tmp can't be opened for writing
+    vector<int> w(50,2);
+    bool thrown = false;
+    try{
+        save_snapshot(path,w);
+    }catch(std::system_error&){
+        thrown = true;
+    }
+    ::rmdir(tmp.c_str());
+    CHECK(thrown);
+    vector<int> r;
+    load_snapshot(path,r);
+    CHECK(r.size()==100 && r[99]==1);
+}
+
+static void test_bad_count(const char* path)
+{
+    vector<std::string> s;
+    for(int i=0 ; i<10 ; ++i) s.push_back("x");
+    save_snapshot(path,s);              // 10 records of 5 bytes: 12 would fit 4 bytes each
+    vector<std::string> t;
+    set_count(path,13);
+    CHECK(rejected(path,t) && t.size()==0);
+    set_count(path,std::uint64_t(1)<<40);
+    CHECK(rejected(path,t));
+    set_count(path,12);                 // fits the payload, but the records run out
+    CHECK(rejected(path,t));
+
+    vector<long> v(16);
+    save_snapshot(path,v);
+    vector<long> w;
+    set_count(path,(std::uint64_t(1)<<61)+16);     // times 8 wraps back to the payload size
+    CHECK(rejected(path,w) && w.size()==0);
+    set_count(path,15);
+    CHECK(rejected(path,w));
+}
+
+int main()
+{
+    const char* path = "test_snapshot.bin";
+    test_round_trip(path);
+    test_many_strings(path);
+    test_bad_count(path);
+    test_failed_save(path);
+    std::remove(path);
+
+    if(failures){
+        std::cerr << failures << " snapshot check(s) failed\n";
+        return 1;
+    }
+    std::cout << "every snapshot check holds\n";
+    return 0;
+}
@@ -0,0 +1,1687 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <stdexcept>
+#include <string>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <cstring>
+#include <iterator>
+#include <cassert>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+
+// owns a block from an allocator until release(); if an exception unwinds
+// first, the block goes back to the allocator it came from. it lives on the
+// stack, so guarding a reallocation costs no allocation of its own
+template<class T, class A>
+class buffer_guard {
+    A& alloc;
+    T* p;
+    std::size_t n;
+public:
+    buffer_guard(A& a, std::size_t count) : alloc(a), p(count ? a.allocate(count) : 0), n(count) {}
+    ~buffer_guard() { if(p) alloc.deallocate(p,n); }
+
+    T* get() const { return p; }
+    T* release() { T* q = p; p = 0; return q; }
+private:
+    buffer_guard(const buffer_guard&);
+    buffer_guard& operator=(const buffer_guard&);
+};
+
+struct Range_error : std::out_of_range {
+    int index;
+    Range_error(int i) : out_of_range("Range error"), index(i) {}
+};
+
+// a type is trivially relocatable when moving it to a new address and forgetting
+// the old one is the same as memcpy'ing its bytes. trivially copyable types are,
+// other types (owning handles, pimpl classes...) can opt in by specializing this
+template<class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// allocators that can resize a block, possibly without moving it (see allocators.h)
+template<class A, class = void>
+struct has_reallocate : std::false_type {};
+
+template<class A>
+struct has_reallocate<A, decltype((void)std::declval<A&>().reallocate(
+                             std::declval<typename A::value_type*>(),std::size_t(),std::size_t()))>
+    : std::true_type {};
+
+// allocators that can hand out a block inside the object holding them
+// (small_vector's inline slots, see small_vector.h): such a block can't be
+// handed to another vector
+template<class A, class = void>
+struct has_inline_storage : std::false_type {};
+
+template<class A>
+struct has_inline_storage<A, decltype((void)std::declval<const A&>().owns(
+                                 std::declval<const typename A::value_type*>()))>
+    : std::true_type {};
+
+struct iterator_range_error : std::out_of_range {
+    const char* where;      // string literals only, nothing is copied
+    const char* problem;
+    long index;             // iterator position, counted from begin()
+    long offset;            // the step that left the range, 0 for none
+
+    iterator_range_error(const char* w, const char* p, long i = 0, long off = 0)
+        : out_of_range("iterator_range error"), where(w), problem(p), index(i), offset(off) { msg[0] = 0; }
+
+    // the message is only put together when someone asks for it, into
+    // a buffer that lives as long as the exception
+    const char* what() const throw()
+    {
+        if(msg[0]==0)
+            std::snprintf(msg,sizeof(msg),"%s : %s%s (index %ld, offset %ld)",
+                          out_of_range::what(),where,problem,index,offset);
+        return msg;
+    }
+
+private:
+    mutable char msg[192];
+};
+
+// block generations, for catching iterators that outlived a reallocation: the
+// vector bumps its counter whenever its elements move to another block (or
+// slide within the same one) and a checked_iterator compares it with the
+// value it was made at. the policy picks the counter through its generation
+// typedef: unchecked keeps none, throw_on_error and debug_assert a plain one.
+// the checked iterators derive from the generation's stamp_type, the value
+// they were made at: no_generation's is empty, so under unchecked they are
+// their two pointers and nothing more
+struct no_stamp {
+    explicit no_stamp(unsigned = 0) {}
+    unsigned stamp() const { return 0; }
+};
+
+struct generation_stamp {
+    explicit generation_stamp(unsigned g = 0) : n(g) {}
+    unsigned stamp() const { return n; }
+private:
+    unsigned n;
+};
+
+struct no_generation {
+    typedef no_stamp stamp_type;
+    unsigned get() const { return 0; }
+    void bump() {}
+};
+
+struct counted_generation {
+    typedef generation_stamp stamp_type;
+    counted_generation() : n(0) {}
+    unsigned get() const { return n; }
+    void bump() { ++n; }
+    unsigned n;
+};
+
+// for vectors that other threads hold iterators into: reading the counter
+// while the owner bumps it is no data race. it doesn't make the vector itself
+// thread safe, it turns a read through a freed block into a reported error
+struct atomic_generation {
+    typedef generation_stamp stamp_type;
+    atomic_generation() : n(0) {}
+    unsigned get() const { return n.load(std::memory_order_acquire); }
+    void bump() { n.fetch_add(1,std::memory_order_acq_rel); }
+    std::atomic<unsigned> n;
+};
+
+// what the vector reports about itself, through the policy's stats typedef:
+// blocks allocated (in bytes), reallocations that moved the elements,
+// elements shifted by insert and erase, the biggest block so far and checked
+// iterator failures. no_stats inlines to nothing; vector_stats.h counts
+struct no_stats {
+    static void allocated(std::size_t) {}
+    static void reallocated() {}
+    static void shifted(long) {}
+    static void capacity(std::size_t) {}
+    static void range_failure() {}
+};
+
+// what a checked_iterator does when it would leave [begin(),end()], or is
+// used after its vector reallocated:
+//  throw_on_error  throws iterator_range_error (debug and test builds)
+//  debug_assert    assert()s, so it vanishes with NDEBUG as well
+//  unchecked       nothing; the iterator optimizes down to its raw pointer
+struct throw_on_error {
+    typedef counted_generation generation;
+    typedef no_stats stats;
+    static void check(bool ok, const char* where, const char* what, long index = 0, long offset = 0)
+    {
+        if(!ok) fail(where,what,index,offset);
+    }
+
+    // out of line, so the checks inlined into every ++ and * stay a compare and a branch
+#if defined(__GNUC__)
+    __attribute__((noinline, cold))
+#endif
+    [[noreturn]] static void fail(const char* where, const char* what, long index, long offset)
+    {
+        throw iterator_range_error(where,what,index,offset);
+    }
+};
+
+struct debug_assert {
+    typedef counted_generation generation;
+    typedef no_stats stats;
+    static void check(bool ok, const char*, const char*, long = 0, long = 0)
+    {
+        assert(ok && "checked_iterator out of range");
+        (void)ok;
+    }
+};
+
+struct unchecked {
+    typedef no_generation generation;
+    typedef no_stats stats;
+    static void check(bool, const char*, const char*, long = 0, long = 0) {}
+};
+
+// pick the default with -DVECTOR_CHECK_POLICY=..., otherwise release builds don't check
+#ifndef VECTOR_CHECK_POLICY
+#  ifdef NDEBUG
+#    define VECTOR_CHECK_POLICY unchecked
+#  else
+#    define VECTOR_CHECK_POLICY throw_on_error
+#  endif
+#endif
+
+// opt in for a shared container: vector<T,A,shared_check<> > checks like
+// Check does, with the generation atomic
+template<class Check = throw_on_error>
+struct shared_check : Check {
+    typedef atomic_generation generation;
+};
+
+// growth policies: grow(space, needed, sizeof(T)) returns the capacity to
+// reallocate to once space is exhausted, never less than needed. Initial is
+// the first allocation, made by the first insertion into an empty vector;
+// vector::set_initial_capacity() overrides it for one vector
+
+template<int Initial = 8>
+struct double_growth {  // fewest reallocations, up to half the block unused
+    static int grow(int space, int needed, std::size_t)
+    {
+        int n = space==0 ? Initial : 2*space;
+        return n<needed ? needed : n;
+    }
+};
+
+template<int Initial = 8>
+struct golden_growth {  // 1.5x: less slack, and freed blocks can be reused by later growth
+    static int grow(int space, int needed, std::size_t)
+    {
+        int n = space==0 ? Initial : space+(space+1)/2;
+        return n<needed ? needed : n;
+    }
+};
+
+template<int Chunk, int Initial = Chunk>
+struct chunk_growth {   // fixed steps: bounded slack, but growth turns quadratic
+    static int grow(int space, int needed, std::size_t)
+    {
+        int n = space==0 ? Initial : space+Chunk;
+        return n<needed ? needed : n;
+    }
+};
+
+template<int Initial = 8>
+struct size_class_growth {  // 1.5x rounded up to a jemalloc size class, so the slack is usable
+    static int grow(int space, int needed, std::size_t elem_size)
+    {
+        int n = space==0 ? Initial : space+(space+1)/2;
+        if(n<needed) n = needed;
+        return int(size_class(std::size_t(n)*elem_size)/elem_size);
+    }
+
+    // 8, 16, 32, 48, 64, 80... then four classes per doubling
+    static std::size_t size_class(std::size_t bytes)
+    {
+        if(bytes<=8) return 8;
+        if(bytes<=16) return 16;
+        if(bytes<=64) return (bytes+15) & ~std::size_t(15);
+        std::size_t pow2 = 64;
+        while(pow2*2<bytes) pow2 *= 2;
+        std::size_t step = pow2/4;
+        return (bytes+step-1)/step*step;
+    }
+};
+
+template<class T, class A = std::allocator<T>, class C = VECTOR_CHECK_POLICY, class G = double_growth<> >
+class vector {
+    A alloc;
+    T* elem;
+    int sz;
+    int space;
+    int head;   // free slots in front of elem, the block starts at elem-head
+    int first_block;    // set_initial_capacity(), 0 for G's Initial
+    typename C::generation gen;     // bumped when the elements move, see checked_iterator
+    typedef typename C::generation::stamp_type stamp_type;
+
+    typedef std::allocator_traits<A> alloc_traits;
+    typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value> trivial_copy;
+    typedef std::integral_constant<bool, is_trivially_relocatable<T>::value> trivial_relocate;
+    typedef std::integral_constant<bool, is_trivially_relocatable<T>::value
+                                        && has_reallocate<A>::value> trivial_realloc;
+
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef unsigned long size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef C check_policy;
+    class checked_iterator;
+    class const_checked_iterator;
+
+public:
+
+    vector() : elem(0), sz(0), space(0), head(0), first_block(0) {}
+
+    explicit vector(const A& a) : alloc(a), elem(0), sz(0), space(0), head(0), first_block(0) {}
+
+    explicit vector(int n, T def = T(), const A& a = A())
+        : alloc(a), elem(0), sz(0), space(0), head(0), first_block(0)
+    {
+        assign(n,def);
+    }
+
+    vector(const vector& v)
+        : alloc(std::allocator_traits<A>::select_on_container_copy_construction(v.alloc)),
+          elem(0), sz(0), space(0), head(0), first_block(0)
+    {
+        assign(v.begin(),v.end());
+    }
+
+    // steals the block, leaving v empty. a block inside v itself (a
+    // small_vector's slots) stays there and the elements are moved out
+    vector(vector&& v) noexcept(!has_inline_storage<A>::value)
+        : alloc(moved_allocator(v.alloc,has_inline_storage<A>())), elem(0), sz(0), space(0), head(0), first_block(0)
+    {
+        take(v,has_inline_storage<A>());
+    }
+
+    vector& operator=(const vector& v)  // reuses the block when v fits; basic guarantee
+    {
+        if(this!=&v){
+            copy_allocator(v,typename alloc_traits::propagate_on_container_copy_assignment());
+            assign(v.begin(),v.end());
+        }
+        return *this;
+    }
+
+    // steals v's block when the allocators allow it, moves element by element otherwise
+    vector& operator=(vector&& v)
+    {
+        if(this!=&v) move_assign(v,typename alloc_traits::propagate_on_container_move_assignment());
+        return *this;
+    }
+
+    // exchanges the blocks; a block inside v or *this (a small_vector's slots)
+    // stays where it is and the elements are moved instead
+    void swap(vector& v);
+
+    void assign_strong(const vector& v);    // copy-and-swap: a copy of v, or untouched
+
+    ~vector()
+    {
+        for(int i=0 ; i<sz ; ++i) alloc.destroy(&elem[i]);
+        alloc.deallocate(elem-head,head+space);
+    }
+
+    T& at(int n)
+    {
+        if(n<0 || sz<=n) throw Range_error(n);
+        return elem[n];
+    }
+
+    const T& at(int n) const
+    {
+        if(n<0 || sz<=n) throw Range_error(n);
+        return elem[n];
+    }
+
+    T& operator[](int i) { return elem[i]; }
+    const T& operator[](int i) const { return elem[i]; }
+
+    void reserve(int newalloc);
+    void reserve_front(int newhead);
+    void shrink_to_fit();     // give back every unused slot, at both ends
+    void resize(int newsize, T def = T());
+
+    void push_back(const T& d) { emplace_back(d); }
+    void push_back(T&& d) { emplace_back(std::move(d)); }
+    template<class... Args> void emplace_back(Args&&... args);
+    void push_front(const T& d) { emplace_front(d); }
+    void push_front(T&& d) { emplace_front(std::move(d)); }
+    template<class... Args> void emplace_front(Args&&... args);
+    void pop_front();
+    void pop_back();
+    T& back() { return *(end()-1); }
+    T& front() { return *begin(); }
+    const T& back() const { return *(end()-1); }
+    const T& front() const { return *begin(); }
+
+    iterator begin() { return elem; }
+    iterator end() { return elem+sz; }
+
+    const_iterator begin() const { return elem; }
+    const_iterator end() const { return elem+sz; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    checked_iterator checked_begin() { return checked_iterator(this,elem); }
+    checked_iterator checked_end() { return checked_iterator(this,elem+sz); }
+
+    const_checked_iterator checked_cbegin() { return checked_iterator(this,elem); }
+    const_checked_iterator checked_cend() { return checked_iterator(this,elem+sz); }
+
+    iterator insert(iterator p, const T& val) { return insert_one(p,val); }
+    iterator insert(iterator p, T&& val) { return insert_one(p,std::move(val)); }
+    iterator erase(iterator p);
+
+    // bulk versions: one size computation, at most one reallocation and one shift
+    // of the tail. [first,last) must not point into *this
+    template<class It, class = typename std::enable_if<!std::is_integral<It>::value>::type>
+    iterator insert(iterator p, It first, It last);
+    iterator insert(iterator p, int n, const T& val);
+    iterator erase(iterator first, iterator last);
+
+    template<class It, class = typename std::enable_if<!std::is_integral<It>::value>::type>
+    void assign(It first, It last);
+    void assign(int n, const T& val);
+    void clear();     // keeps the whole block, front gap included, for the next fill
+
+    A get_allocator() const { return alloc; }
+
+protected:
+    // take v's block as is; only for when alloc can free what v's allocator gave out
+    void adopt(vector& v)
+    {
+        release_storage();
+        elem = v.elem; sz = v.sz; space = v.space; head = v.head;
+        v.gen.bump();
+        v.elem = 0;
+        v.sz = v.space = v.head = 0;
+    }
+
+    // take a block alloc gave out, holding n elements from block+front on
+    void adopt(T* block, int front, int n, int cap)
+    {
+        release_storage();
+        elem = block+front; sz = n; space = cap; head = front;
+    }
+
+public:
+
+    int size() const { return sz; }
+    int capacity() const { return space; }
+    int front_capacity() const { return head; }    // push_front()s left before reallocating
+    unsigned generation() const { return gen.get(); }   // how many times the elements have moved
+
+    // the block the first insertion into this vector (empty, with no block)
+    // allocates, in place of G's Initial; 0 goes back to G's. it is a setting
+    // of this object: copies, moves and swaps leave it where it is
+    void set_initial_capacity(int n) { first_block = n<0 ? 0 : n; }
+    int initial_capacity() const { return first_block ? first_block : G::grow(0,1,sizeof(T)); }
+
+private:
+    template<class... Args> void grow_back(Args&&... args);
+    template<class U> void move_back(const iterator&,U&&);
+    template<class U> iterator insert_one(iterator,U&&);
+    template<class U> iterator insert_one(iterator,U&&,std::true_type);
+    template<class U> iterator insert_one(iterator,U&&,std::false_type);
+    iterator erase(iterator,std::true_type);
+    iterator erase(iterator,std::false_type);
+
+    template<class It> iterator insert(iterator,It,It,std::input_iterator_tag);
+    template<class It> iterator insert(iterator,It,It,std::forward_iterator_tag);
+    template<class It> iterator insert_range(iterator,It,int);
+    template<class It> void insert_gap(iterator,It,int,std::true_type);
+    template<class It> void insert_gap(iterator,It,int,std::false_type);
+    template<class It> void assign(It,It,std::input_iterator_tag);
+    template<class It> void assign(It,It,std::forward_iterator_tag);
+    template<class It> void assign(It,It,std::forward_iterator_tag,int);
+
+    // the same value n times, so fill insert/assign can share the range code
+    struct fill_iterator {
+        const T* val;
+        const T& operator*() const { return *val; }
+        fill_iterator& operator++() { return *this; }
+    };
+
+    // construct n elements from first into raw memory; all or nothing
+    template<class It>
+    void construct_range(T* dst, It first, int n)
+    {
+        construct_range(dst,first,n,std::integral_constant<bool, trivial_copy::value
+                                                  && std::is_convertible<It,const T*>::value>());
+    }
+    template<class It>
+    void construct_range(T* dst, It first, int n, std::true_type)
+    {
+        copy_construct(dst,first,n,trivial_copy());
+    }
+    template<class It>
+    void construct_range(T* dst, It first, int n, std::false_type)
+    {
+        int i=0;
+        try{
+            for( ; i<n ; ++i, ++first) alloc.construct(&dst[i],*first);
+        }catch(...){
+            for(int j=0 ; j<i ; ++j) alloc.destroy(&dst[j]);
+            throw;
+        }
+    }
+
+    // resize the block through A::reallocate, to newhead free slots in front and
+    // newalloc from elem on; false when A can't (or there is no block yet)
+    bool grow_in_place(int newhead, int newalloc, std::true_type);
+    bool grow_in_place(int, int, std::false_type) { return false; }
+
+    int next_capacity(int needed) const
+    {
+        if(space==0 && first_block) return first_block<needed ? needed : first_block;
+        return G::grow(space,needed,sizeof(T));
+    }
+
+    // a new block of n slots for C::stats; moved: the elements are carried over
+    void note_block(int n, bool moved)
+    {
+        C::stats::allocated(std::size_t(n)*sizeof(T));
+        if(moved && elem) C::stats::reallocated();
+        C::stats::capacity(std::size_t(n)*sizeof(T));
+    }
+
+    void copy_construct(T* dst, const T* src, int n, std::true_type)
+    {
+        if(0<n) std::memcpy(static_cast<void*>(dst),src,std::size_t(n)*sizeof(T));
+    }
+    void copy_construct(T* dst, const T* src, int n, std::false_type)
+    {
+        construct_range(dst,src,n,std::false_type());
+    }
+
+    void destroy_range(T* p, int n)
+    {
+        for(int i=0 ; i<n ; ++i) alloc.destroy(&p[i]);
+    }
+
+    // slide the elements back to the start of the block, when the front gap
+    // has outgrown them: a vector drained from the front (a FIFO) then reuses
+    // its block, instead of carrying an ever longer gap into every new one
+    void reclaim_front()
+    {
+        T* block = elem-head;
+        relocate(block,elem,sz,trivial_relocate());     // disjoint: the gap is longer than the elements
+        gen.bump();
+        elem = block;
+        space += head;
+        head = 0;
+    }
+
+    // an empty vector keeps no front gap
+    void reclaim_if_empty()
+    {
+        if(sz || head==0) return;
+        gen.bump();
+        elem -= head;
+        space += head;
+        head = 0;
+    }
+
+    // what a vector moved from v's allocator gets: never one that can hand out v's slots
+    static A moved_allocator(A& a, std::false_type) { return std::move(a); }
+    static A moved_allocator(A& a, std::true_type) { return alloc_traits::select_on_container_copy_construction(a); }
+
+    void take(vector& v, std::false_type)
+    {
+        elem = v.elem; sz = v.sz; space = v.space; head = v.head;
+        v.gen.bump();
+        v.elem = 0;
+        v.sz = v.space = v.head = 0;
+    }
+    void take(vector& v, std::true_type)
+    {
+        if(!v.alloc.owns(v.elem)){
+            take(v,std::false_type());
+            return;
+        }
+        assign(std::make_move_iterator(v.begin()),std::make_move_iterator(v.end()));
+        v.clear();
+    }
+
+    // whether elem is in a block that lives inside the object holding alloc
+    bool inline_block(std::false_type) const { return false; }
+    bool inline_block(std::true_type) const { return alloc.owns(elem); }
+
+    void release_storage()
+    {
+        destroy_range(elem,sz);
+        gen.bump();
+        alloc.deallocate(elem-head,head+space);
+        elem = 0;
+        sz = space = head = 0;
+    }
+
+    void copy_allocator(const vector& v, std::true_type)
+    {
+        if(alloc!=v.alloc) release_storage();   // our block must go back where it came from
+        alloc = v.alloc;
+    }
+    void copy_allocator(const vector&, std::false_type) {}
+
+    void move_assign(vector& v, std::true_type)
+    {
+        release_storage();
+        alloc = std::move(v.alloc);
+        adopt(v);
+    }
+    void move_assign(vector& v, std::false_type)
+    {
+        if(alloc==v.alloc){
+            adopt(v);
+            return;
+        }
+        assign(std::make_move_iterator(v.begin()),std::make_move_iterator(v.end()));
+        v.clear();
+    }
+
+    // move n elements to uninitialized dst, leaving src as raw memory
+    void relocate(T* dst, T* src, int n, std::true_type tag)
+    {
+        uninitialized_relocate(dst,src,n,tag);
+    }
+    void relocate(T* dst, T* src, int n, std::false_type tag)
+    {
+        uninitialized_relocate(dst,src,n,tag);
+        destroy_range(src,n);
+    }
+
+    // the first half of relocate: build dst, all or nothing, but leave src
+    // alive until the caller knows nothing else can throw
+    void uninitialized_relocate(T* dst, T* src, int n, std::true_type)
+    {
+        if(0<n) std::memcpy(static_cast<void*>(dst),static_cast<void*>(src),std::size_t(n)*sizeof(T));
+    }
+    void uninitialized_relocate(T* dst, T* src, int n, std::false_type)
+    {
+        // move when T's move can't throw, otherwise copy so a throwing
+        // constructor leaves the source untouched
+        int i=0;
+        try{
+            for( ; i<n ; ++i) alloc.construct(&dst[i],std::move_if_noexcept(src[i]));
+        }catch(...){
+            destroy_range(dst,i);
+            throw;
+        }
+    }
+};
+
+template<class T, class A, class C, class G> class vector<T,A,C,G>::checked_iterator : private stamp_type {   // with pointer semantics
+public:
+    typedef typename vector<T,A,C,G>::iterator_category iterator_category;
+    typedef typename vector<T,A,C,G>::value_type        value_type;
+    typedef typename vector<T,A,C,G>::difference_type   difference_type;
+    typedef typename vector<T,A,C,G>::pointer           pointer;
+    typedef typename vector<T,A,C,G>::reference         reference;
+    typedef vector<T,A,C,G>                           container_type;
+    friend class vector<T,A,C,G>::const_checked_iterator;
+
+public:
+    checked_iterator() :current(0), vec_obj(0) {}
+
+    explicit checked_iterator(const vector<T,A,C,G>* v)
+        :stamp_type(v->gen.get()), current(v->elem), vec_obj(v) { }
+
+    checked_iterator(const vector<T,A,C,G>* v, iterator p) throw(iterator_range_error)
+        :stamp_type(v->gen.get()), current(p), vec_obj(v) { check_position(p,"checked_iterator(const vector<T,A,C,G>*, iterator)"); }
+
+    T& operator*() throw(iterator_range_error)
+    {
+        check_fresh("T& operator*()");
+        C::check(current!=vec_obj->elem+vec_obj->sz,"T& operator*()"," derefrence end()",current-vec_obj->elem);
+        return *current;
+    }
+    T& operator[](size_type n) { return *(*this+n); }
+    const T& operator[](size_type n) const { return *(*this+n); }
+
+    const T& operator*() const throw(iterator_range_error)
+    {
+        check_fresh("const T& operator*()");
+        C::check(current!=vec_obj->elem+vec_obj->sz,"const T& operator*()"," derefrence end()",current-vec_obj->elem);
+        return *current;
+    }
+    T* operator->() { return current; }
+
+    checked_iterator& operator++() throw(iterator_range_error);
+    checked_iterator operator++(int) throw(iterator_range_error);
+
+    checked_iterator& operator--() throw(iterator_range_error);
+    checked_iterator operator--(int) throw(iterator_range_error);
+
+    checked_iterator& operator+=(size_type n) throw(iterator_range_error);
+    checked_iterator& operator-=(size_type n) throw(iterator_range_error);
+
+    checked_iterator operator+(size_type n) throw(iterator_range_error);
+    checked_iterator operator-(size_type n) throw(iterator_range_error);
+    difference_type operator-(const checked_iterator& other) { return current-other.current; }
+    difference_type operator-(typename vector<T,A,C,G>::const_checked_iterator& other) { return current - other.current; }
+
+    bool operator==(const checked_iterator& other) const
+    {
+        return current==other.current;
+    }
+
+    bool operator==(const const_checked_iterator& other) const
+    {
+        return current==other.current;
+    }
+
+    bool operator==(const iterator& other) const
+    {
+        return current==&*other;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+        return current==&*other;
+    }
+
+    bool operator!=(const checked_iterator& other) const
+    {
+        return current!=other.current;
+    }
+
+    bool operator!=(const const_checked_iterator& other) const
+    {
+        return current!=other.current;
+    }
+
+    bool operator!=(const iterator& other) const
+    {
+        return current!=&*other;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+        return current!=&*other;
+    }
+
+    bool operator<(const checked_iterator& other) const
+    {
+        return current<other.current;
+    }
+
+    bool operator<(const const_checked_iterator& other) const
+    {
+        return current<other.current;
+    }
+
+    bool operator<(const iterator& other) const
+    {
+        return current<&*other;
+    }
+
+    bool operator<(const const_iterator& other) const
+    {
+        return current<&*other;
+    }
+
+    bool operator>(const checked_iterator& other) const
+    {
+        return current>other.current;
+    }
+
+    bool operator>(const const_checked_iterator& other) const
+    {
+        return current>other.current;
+    }
+
+    bool operator>(const iterator& other) const
+    {
+        return current>&*other;
+    }
+
+    bool operator>(const const_iterator& other) const
+    {
+        return current>&*other;
+    }
+
+    bool operator<=(const checked_iterator& other) const
+    {
+        return current<=other.current;
+    }
+
+    bool operator<=(const const_checked_iterator& other) const
+    {
+        return current<=other.current;
+    }
+
+    bool operator<=(const iterator& other) const
+    {
+        return current<=&*other;
+    }
+
+    bool operator<=(const const_iterator& other) const
+    {
+        return current<=&*other;
+    }
+
+    bool operator>=(const checked_iterator& other) const
+    {
+        return current>=other.current;
+    }
+
+    bool operator>=(const const_checked_iterator& other) const
+    {
+        return current>=other.current;
+    }
+
+    bool operator>=(const iterator& other) const
+    {
+        return current>=&*other;
+    }
+
+    bool operator>=(const const_iterator& other) const
+    {
+        return current>=&*other;
+    }
+
+    iterator plain_iterator() const { return current; }
+    const vector<T,A,C,G>* container() const { return vec_obj; }
+    unsigned generation() const { return this->stamp(); }
+
+private:
+    // O(1): the vector's block generation against the one this was made at
+    void check_fresh(const char* s) const throw(iterator_range_error)
+    {
+        C::check(this->stamp()==vec_obj->gen.get(),s," used after its vector reallocated");
+    }
+
+    void check_position(const T* p, const char* s, difference_type offset = 0) throw(iterator_range_error)
+    {
+        check_fresh(s);
+        C::check(p<=vec_obj->elem+vec_obj->sz,s," passed end()",p-offset-vec_obj->elem,offset);
+        C::check(vec_obj->elem<=p,s," before begin()",p-offset-vec_obj->elem,offset);
+    }
+
+private:
+    T* current;
+    const vector<T,A,C,G>* vec_obj;
+};
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator& vector<T,A,C,G>::checked_iterator::operator++() throw(iterator_range_error)
+{
+    check_fresh("checked_iterator::operator++()");
+    C::check(current!=vec_obj->elem+vec_obj->sz,"checked_iterator::operator++()"," surpasses end()",current-vec_obj->elem,1);
+    ++current;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator vector<T,A,C,G>::checked_iterator::operator++(int) throw(iterator_range_error)
+{
+    check_fresh("checked_iterator::operator++(int)");
+    C::check(current!=vec_obj->elem+vec_obj->sz,"checked_iterator::operator++(int)"," surpasses end()",current-vec_obj->elem,1);
+    T* temp = current;
+    ++current;
+    return checked_iterator(vec_obj,temp);
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator& vector<T,A,C,G>::checked_iterator::operator--() throw(iterator_range_error)
+{
+    check_fresh("checked_iterator::operator--()");
+    C::check(current!=vec_obj->elem,"checked_iterator::operator--()"," precedes begin()",current-vec_obj->elem,-1);
+    --current;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator vector<T,A,C,G>::checked_iterator::operator--(int) throw(iterator_range_error)
+{
+    check_fresh("checked_iterator::operator--(int)");
+    C::check(current!=vec_obj->elem,"checked_iterator::operator--(int)"," precedes begin()",current-vec_obj->elem,-1);
+    T* temp = this->current;
+    --current;
+    return checked_iterator(vec_obj,temp);
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator& vector<T,A,C,G>::checked_iterator::operator+=(size_type n) throw(iterator_range_error)
+{
+    check_position(current+n,"checked_iterator::operator+=(size_type)/(+)",difference_type(n));
+    current += n;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator& vector<T,A,C,G>::checked_iterator::operator-=(size_type n) throw(iterator_range_error)
+{
+    check_position(current-n,"checked_iterator::operator-=(size_type)/(-)",-difference_type(n));
+    current -= n;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator vector<T,A,C,G>::checked_iterator::operator+(size_type n) throw(iterator_range_error)
+{
+    checked_iterator temp(*this);
+    return temp+=n;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::checked_iterator vector<T,A,C,G>::checked_iterator::operator-(size_type n) throw(iterator_range_error)
+{
+    checked_iterator temp(*this);
+    return temp-=n;
+}
+
+template<class T, class A, class C, class G>
+class vector<T,A,C,G>::const_checked_iterator : private stamp_type {   // with pointer semantics
+public:
+    typedef typename vector<T,A,C,G>::iterator_category iterator_category;
+    typedef typename vector<T,A,C,G>::value_type        value_type;
+    typedef typename vector<T,A,C,G>::difference_type   difference_type;
+    typedef typename vector<T,A,C,G>::pointer           pointer;
+    typedef typename vector<T,A,C,G>::reference         reference;
+    typedef vector<T,A,C,G>                           container_type;
+    friend class vector<T,A,C,G>::checked_iterator;
+
+public:
+    const_checked_iterator() :current(0), vec_obj(0) {}
+
+    const_checked_iterator(const checked_iterator& p)   // no need to check, since checked_iterator
+        :stamp_type(p.generation()), current(p.current), vec_obj(p.vec_obj) {}      // does the check for us
+
+    const_checked_iterator(const vector<T,A,C,G>* v, const_iterator p) throw(iterator_range_error)
+        :stamp_type(v->gen.get()), current(p), vec_obj(v) { check_position(p,"const_checked_iterator(const vector<T,A,C,G>*, const_iterator)"); }
+
+    const_checked_iterator(const vector<T,A,C,G>* v, iterator p) throw(iterator_range_error)
+        :stamp_type(v->gen.get()), current(p), vec_obj(v) { check_position(p,"const_checked_iterator(const vector<T,A,C,G>*, iterator)"); }
+
+    const T& operator*() const throw(iterator_range_error)
+    {
+        check_fresh("const T& operator*()");
+        C::check(current!=vec_obj->elem+vec_obj->sz,"const T& operator*()"," derefrence end()",current-vec_obj->elem);
+        return *current;
+    }
+    const T& operator[](size_type n) { return *(*this+n); }
+    const T* operator->() const { return current; }
+
+    const_checked_iterator& operator++() throw(iterator_range_error);
+    const_checked_iterator operator++(int) throw(iterator_range_error);
+
+    const_checked_iterator& operator--() throw(iterator_range_error);
+    const_checked_iterator operator--(int) throw(iterator_range_error);
+
+    const_checked_iterator& operator+=(size_type) throw(iterator_range_error);
+    const_checked_iterator& operator-=(size_type) throw(iterator_range_error);
+
+    const_checked_iterator operator+(size_type) throw(iterator_range_error);
+    const_checked_iterator operator-(size_type) throw(iterator_range_error);
+    difference_type operator-(typename vector<T,A,C,G>::const_checked_iterator& other) { return current - other.current; }
+    difference_type operator-(typename vector<T,A,C,G>::checked_iterator& other) { return current - other.current; }
+
+    bool operator==(const const_checked_iterator& other) const
+    {
+        return current==other.current;
+    }
+
+    bool operator==(const checked_iterator& other) const
+    {
+        return current==other.current;
+    }
+
+    bool operator==(const iterator& other) const
+    {
+        return current==&*other;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+        return current==&*other;
+    }
+
+    bool operator!=(const const_checked_iterator& other) const
+    {
+        return current!=other.current;
+    }
+
+    bool operator!=(const checked_iterator& other) const
+    {
+        return current!=other.current;
+    }
+
+    bool operator!=(const iterator& other) const
+    {
+        return current!=&*other;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+        return current!=&*other;
+    }
+
+    bool operator<(const const_checked_iterator& other) const
+    {
+        return current<other.current;
+    }
+
+    bool operator<(const checked_iterator& other) const
+    {
+        return current<other.current;
+    }
+
+    bool operator<(const iterator& other) const
+    {
+        return current<&*other;
+    }
+
+    bool operator<(const const_iterator& other) const
+    {
+        return current<&*other;
+    }
+
+    bool operator>(const const_checked_iterator& other) const
+    {
+        return current>other.current;
+    }
+
+    bool operator>(const checked_iterator& other) const
+    {
+        return current>other.current;
+    }
+
+    bool operator>(const iterator& other) const
+    {
+        return current>&*other;
+    }
+
+    bool operator>(const const_iterator& other) const
+    {
+        return current>&*other;
+    }
+
+    bool operator<=(const const_checked_iterator& other) const
+    {
+        return current<=other.current;
+    }
+
+    bool operator<=(const checked_iterator& other) const
+    {
+        return current<=other.current;
+    }
+
+    bool operator<=(const iterator& other) const
+    {
+        return current<=&*other;
+    }
+
+    bool operator<=(const const_iterator& other) const
+    {
+        return current<=&*other;
+    }
+
+    bool operator>=(const const_checked_iterator& other) const
+    {
+        return current>=other.current;
+    }
+
+    bool operator>=(const checked_iterator& other) const
+    {
+        return current>=other.current;
+    }
+
+    bool operator>=(const iterator& other) const
+    {
+        return current>=&*other;
+    }
+
+    bool operator>=(const const_iterator& other) const
+    {
+        return current>=&*other;
+    }
+
+    const_iterator plain_iterator() const { return current; }
+    const vector<T,A,C,G>* container() const { return vec_obj; }
+    unsigned generation() const { return this->stamp(); }
+
+private:
+    void check_fresh(const char* s) const throw(iterator_range_error)
+    {
+        C::check(this->stamp()==vec_obj->gen.get(),s," used after its vector reallocated");
+    }
+
+    void check_position(const T* p, const char* s, difference_type offset = 0) throw(iterator_range_error)
+    {
+        check_fresh(s);
+        C::check(p<=vec_obj->elem+vec_obj->sz,s," passed end()",p-offset-vec_obj->elem,offset);
+        C::check(vec_obj->elem<=p,s," before begin()",p-offset-vec_obj->elem,offset);
+    }
+
+private:
+    const T* current;
+    const vector<T,A,C,G>* vec_obj;
+};
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator& vector<T,A,C,G>::const_checked_iterator::operator++() throw(iterator_range_error)
+{
+    check_fresh("const_checked_iterator::operator++()");
+    C::check(current!=vec_obj->elem+vec_obj->sz,"const_checked_iterator::operator++()"," surpasses end()",current-vec_obj->elem,1);
+    ++current;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator vector<T,A,C,G>::const_checked_iterator::operator++(int) throw(iterator_range_error)
+{
+    check_fresh("const_checked_iterator::operator++(int)");
+    C::check(current!=vec_obj->elem+vec_obj->sz,"const_checked_iterator::operator++(int)"," surpasses end()",current-vec_obj->elem,1);
+    const T* temp = this->current;
+    ++current;
+    return const_checked_iterator(vec_obj,temp);
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator& vector<T,A,C,G>::const_checked_iterator::operator--() throw(iterator_range_error)
+{
+    check_fresh("const_checked_iterator::operator--()");
+    C::check(current!=vec_obj->elem,"const_checked_iterator::operator--()"," precedes begin()",current-vec_obj->elem,-1);
+    --current;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator vector<T,A,C,G>::const_checked_iterator::operator--(int) throw(iterator_range_error)
+{
+    check_fresh("const_checked_iterator::operator--(int)");
+    C::check(current!=vec_obj->elem,"const_checked_iterator::operator--(int)"," precedes begin()",current-vec_obj->elem,-1);
+    const T* temp = this->current;
+    --current;
+    return const_checked_iterator(vec_obj,temp);
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator& vector<T,A,C,G>::const_checked_iterator::operator+=(size_type n) throw(iterator_range_error)
+{
+    check_position(current+n,"const_checked_iterator::operator+=(size_type)/(+)",difference_type(n));
+    current += n;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator& vector<T,A,C,G>::const_checked_iterator::operator-=(size_type n) throw(iterator_range_error)
+{
+    check_position(current-n,"const_checked_iterator::operator-=(size_type)/(-)",-difference_type(n));
+    current -= n;
+    return *this;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator vector<T,A,C,G>::const_checked_iterator::operator+(size_type n) throw(iterator_range_error)
+{
+    const_checked_iterator temp(*this);
+    return temp+=n;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::const_checked_iterator vector<T,A,C,G>::const_checked_iterator::operator-(size_type n) throw(iterator_range_error)
+{
+    const_checked_iterator temp(*this);
+    return temp-=n;
+}
+
+//!-----------------------------------------------------------------------------------------------------------------------------------!//
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::swap(vector<T,A,C,G>& v)
+{
+    if(inline_block(has_inline_storage<A>()) || v.inline_block(has_inline_storage<A>())){
+        vector tmp(std::move(v));   // slots can't change hands: the elements move, three times
+        v = std::move(*this);
+        *this = std::move(tmp);
+        return;
+    }
+    if(alloc_traits::propagate_on_container_swap::value){
+        using std::swap;
+        swap(alloc,v.alloc);
+    }
+    gen.bump();
+    v.gen.bump();
+    std::swap(elem,v.elem);     // otherwise the allocators must compare equal
+    std::swap(sz,v.sz);
+    std::swap(space,v.space);
+    std::swap(head,v.head);
+}
+
+template<class T, class A, class C, class G>
+void swap(vector<T,A,C,G>& a, vector<T,A,C,G>& b)
+{
+    a.swap(b);
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::assign_strong(const vector<T,A,C,G>& v)
+{
+    if(this==&v) return;
+    if(trivial_copy::value && trivial_realloc::value){
+        assign(v.begin(),v.end());  // only reallocate can throw, and it leaves the block as it was
+        return;
+    }
+    buffer_guard<T,A> block(alloc,v.sz);
+    note_block(v.sz,false);
+    copy_construct(block.get(),v.elem,v.sz,trivial_copy());
+
+    // nothing below throws: swap the copy in, then let the old block go
+    destroy_range(elem,sz);
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release();
+    sz = space = v.sz;
+    head = 0;
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::reserve(int newalloc)
+{
+    if(newalloc<=space) return; // never decrease allocation
+    if(sz<head){
+        reclaim_front();
+        if(newalloc<=space) return;
+    }
+    if(grow_in_place(head,newalloc,trivial_realloc())) return;
+    buffer_guard<T,A> block(alloc,head+newalloc);
+    note_block(head+newalloc,true);
+
+    relocate(block.get()+head,elem,sz,trivial_relocate());  // the front gap is kept for push_front
+
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release() + head;
+    space = newalloc;
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::reserve_front(int newhead)
+{
+    if(newhead<=head) return;
+    if(grow_in_place(newhead,space,trivial_realloc())) return;
+    buffer_guard<T,A> block(alloc,newhead+space);
+    note_block(newhead+space,true);
+
+    relocate(block.get()+newhead,elem,sz,trivial_relocate());
+
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release() + newhead;
+    head = newhead;
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::shrink_to_fit()
+{
+    if(head==0 && space==sz) return;
+    if(sz && grow_in_place(0,sz,trivial_realloc())) return;
+    buffer_guard<T,A> block(alloc,sz);
+    note_block(sz,true);
+
+    relocate(block.get(),elem,sz,trivial_relocate());
+
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release();
+    space = sz;
+    head = 0;
+}
+
+template<class T, class A, class C, class G>
+bool vector<T,A,C,G>::grow_in_place(int newhead, int newalloc, std::true_type)
+{
+    if(elem==0) return false;
+    T* block = elem-head;
+    if(newhead<head)    // a smaller front gap: slide down first, the block may lose its end
+        std::memmove(static_cast<void*>(block+newhead),static_cast<void*>(elem),sz*sizeof(T));
+    try{
+        // bytes travel with the block, if it moves at all
+        block = alloc.reallocate(block,head+space,newhead+newalloc);
+    }catch(...){
+        if(newhead<head) std::memmove(static_cast<void*>(elem),static_cast<void*>(block+newhead),sz*sizeof(T));
+        throw;
+    }
+    if(head<newhead)
+        std::memmove(static_cast<void*>(block+newhead),static_cast<void*>(block+head),sz*sizeof(T));
+    note_block(newhead+newalloc,true);
+    gen.bump();
+    elem = block+newhead;
+    head = newhead;
+    space = newalloc;
+    return true;
+}
+
+template<class T, class A, class C, class G>
+template<class... Args>
+void vector<T,A,C,G>::emplace_back(Args&&... args)
+{
+    if(sz==space){
+        grow_back(std::forward<Args>(args)...);
+        return;
+    }
+    alloc.construct(&elem[sz],std::forward<Args>(args)...);
+    ++sz;
+}
+
+// emplace_back into a full block. args may be one of our elements
+// (v.push_back(v[0])), so the new element is built in the new block before
+// the old ones leave; when they move within the block (or with it, through
+// realloc) it is taken into a temporary first
+template<class T, class A, class C, class G>
+template<class... Args>
+void vector<T,A,C,G>::grow_back(Args&&... args)
+{
+    int newalloc = next_capacity(sz+1);
+    if(sz<head || (trivial_realloc::value && elem)){
+        T tmp(std::forward<Args>(args)...);
+        reserve(newalloc);      // takes the front gap back first, if that is room enough
+        alloc.construct(&elem[sz],std::move(tmp));
+        ++sz;
+        return;
+    }
+    buffer_guard<T,A> block(alloc,head+newalloc);
+    note_block(head+newalloc,true);
+    T* q = block.get()+head;
+    alloc.construct(q+sz,std::forward<Args>(args)...);
+    try{
+        relocate(q,elem,sz,trivial_relocate());
+    }catch(...){
+        alloc.destroy(q+sz);
+        throw;
+    }
+
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release()+head;
+    space = newalloc;
+    ++sz;
+}
+/*
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::move_back(const T& d)
+{
+    for(int i=sz-1 ; i>0 ; --i)
+        elem[i] = elem[i-1];
+    elem[0] = d;
+}*/
+
+template<class T, class A, class C, class G>
+template<class U>
+void vector<T,A,C,G>::move_back(const typename vector<T,A,C,G>::iterator& p, U&& d)
+{
+    // the last slot already holds the old back(): shift [p,end()-2) up by one
+    if(sz<2) return;
+    for(iterator pos=end()-2 ; pos!=p ; --pos)
+        *pos = std::move(*(pos-1));
+    *p = std::forward<U>(d);
+}
+
+template<class T, class A, class C, class G>
+template<class... Args>
+void vector<T,A,C,G>::emplace_front(Args&&... args)
+{
+    if(head==0){    // double the front gap, like push_back does at the back
+        T tmp(std::forward<Args>(args)...);     // args may live in the block we are leaving
+        reserve_front(sz<8 ? 8 : sz);
+        alloc.construct(elem-1,std::move(tmp));
+    }
+    else alloc.construct(elem-1,std::forward<Args>(args)...);
+    --elem; --head;
+    ++sz; ++space;
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::pop_front()
+{
+    alloc.destroy(elem);
+    ++elem; ++head;
+    --sz; --space;
+    reclaim_if_empty();
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::pop_back()
+{
+    alloc.destroy(&elem[sz-1]);
+    --sz;
+    reclaim_if_empty();
+}
+
+template<class T, class A, class C, class G>
+template<class U>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert_one(typename vector<T,A,C,G>::iterator p, U&& val)
+{
+    size_type index = p - begin();
+    if(p==end()){   // appending, nothing to shift
+        emplace_back(std::forward<U>(val));
+        return begin() + index;
+    }
+    if(p==begin()){ // use the front gap
+        emplace_front(std::forward<U>(val));
+        return begin();
+    }
+    T tmp(std::forward<U>(val));    // val may be one of ours: take it before reserve or the shift moves it
+    if(sz==space) reserve(next_capacity(sz+1));
+
+    C::stats::shifted(sz-long(index));
+    return insert_one(begin()+index,std::move(tmp),trivial_relocate());
+}
+
+template<class T, class A, class C, class G>
+template<class U>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert_one(typename vector<T,A,C,G>::iterator p, U&& val, std::true_type)
+{
+    std::memmove(static_cast<void*>(p+1),static_cast<void*>(p),(end()-p)*sizeof(T));
+    try{
+        alloc.construct(p,std::forward<U>(val));
+    }catch(...){
+        std::memmove(static_cast<void*>(p),static_cast<void*>(p+1),(end()-p)*sizeof(T));
+        throw;
+    }
+    ++sz;
+    return p;
+}
+
+template<class T, class A, class C, class G>
+template<class U>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert_one(typename vector<T,A,C,G>::iterator p, U&& val, std::false_type)
+{
+    alloc.construct(elem+sz,std::move(back()));
+    ++sz;
+    move_back(p,std::forward<U>(val));
+    return p;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::erase(typename vector<T,A,C,G>::iterator p)
+{
+    if(p==end()) return p;
+    if(p==begin()){
+        pop_front();
+        return begin();
+    }
+    C::stats::shifted(end()-p-1);
+    return erase(p,trivial_relocate());
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::erase(typename vector<T,A,C,G>::iterator p, std::true_type)
+{
+    alloc.destroy(p);
+    std::memmove(static_cast<void*>(p),static_cast<void*>(p+1),(end()-p-1)*sizeof(T));
+    --sz;
+    return p;
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::erase(typename vector<T,A,C,G>::iterator p, std::false_type)
+{
+    for( iterator pos=p+1 ; pos!=end() ; ++pos)
+        *(pos-1) = std::move(*pos);
+    alloc.destroy(&*(end()-1));
+
+    --sz;
+    return p;
+}
+
+template<class T, class A, class C, class G>
+template<class It, class>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert(typename vector<T,A,C,G>::iterator p, It first, It last)
+{
+    return insert(p,first,last,typename std::iterator_traits<It>::iterator_category());
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert(typename vector<T,A,C,G>::iterator p, int n, const T& val)
+{
+    T tmp(val);     // val may be one of ours
+    fill_iterator f = { &tmp };
+    return insert_range(p,f,n);
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert(typename vector<T,A,C,G>::iterator p, It first, It last, std::input_iterator_tag)
+{
+    // single pass, the count is unknown: append then rotate into place
+    int index = p - begin();
+    int old_sz = sz;
+    for( ; first!=last ; ++first) emplace_back(*first);
+    C::stats::shifted(old_sz-index);
+    std::rotate(begin()+index,begin()+old_sz,end());
+    return begin()+index;
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert(typename vector<T,A,C,G>::iterator p, It first, It last, std::forward_iterator_tag)
+{
+    return insert_range(p,first,int(std::distance(first,last)));
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::insert_range(typename vector<T,A,C,G>::iterator p, It first, int n)
+{
+    int index = p - begin();
+    if(n<=0) return p;
+    if(sz+n<=space){
+        insert_gap(p,first,n,trivial_relocate());
+        return p;
+    }
+    int newhead = sz<head ? 0 : head;   // a gap longer than the elements isn't carried over
+    if(grow_in_place(newhead,next_capacity(sz+n),trivial_realloc())){
+        insert_gap(elem+index,first,n,trivial_relocate());
+        return elem+index;
+    }
+
+    // reallocate once and lay the new block out around the inserted elements,
+    // so prefix and tail are each relocated exactly once
+    int newalloc = next_capacity(sz+n);
+    buffer_guard<T,A> block(alloc,newhead+newalloc);
+    note_block(newhead+newalloc,true);
+    T* q = block.get()+newhead;
+    construct_range(q+index,first,n);
+    try{
+        uninitialized_relocate(q,elem,index,trivial_relocate());
+        try{
+            uninitialized_relocate(q+index+n,elem+index,sz-index,trivial_relocate());
+        }catch(...){
+            destroy_range(q,index);
+            throw;
+        }
+    }catch(...){
+        destroy_range(q+index,n);
+        throw;
+    }
+    if(!trivial_relocate::value) destroy_range(elem,sz);
+
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release()+newhead;
+    head = newhead;
+    space = newalloc;
+    sz += n;
+    return elem+index;
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+void vector<T,A,C,G>::insert_gap(typename vector<T,A,C,G>::iterator p, It first, int n, std::true_type)
+{
+    int after = end() - p;
+    C::stats::shifted(after);
+    std::memmove(static_cast<void*>(p+n),static_cast<void*>(p),after*sizeof(T));
+    try{
+        construct_range(p,first,n);
+    }catch(...){
+        std::memmove(static_cast<void*>(p),static_cast<void*>(p+n),after*sizeof(T));
+        throw;
+    }
+    sz += n;
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+void vector<T,A,C,G>::insert_gap(typename vector<T,A,C,G>::iterator p, It first, int n, std::false_type)
+{
+    iterator old_end = end();
+    int after = old_end - p;
+    C::stats::shifted(after);
+    if(n<after){
+        // the last n elements go to raw memory, the rest of the tail moves within
+        // constructed slots and the new values are assigned over moved-from ones
+        for(int i=0 ; i<n ; ++i){
+            alloc.construct(old_end+i,std::move(old_end[i-n]));
+            ++sz;
+        }
+        std::move_backward(p,old_end-n,old_end);
+        for(int i=0 ; i<n ; ++i, ++first) p[i] = *first;
+    }
+    else{
+        // the new values overhang end(): construct the overhang, move the whole
+        // tail behind it and assign the rest
+        It mid = first;
+        for(int i=0 ; i<after ; ++i) ++mid;
+        construct_range(old_end,mid,n-after);
+        sz += n-after;
+        for(int i=0 ; i<after ; ++i){
+            alloc.construct(old_end+(n-after)+i,std::move(p[i]));
+            ++sz;
+        }
+        for(int i=0 ; i<after ; ++i, ++first) p[i] = *first;
+    }
+}
+
+template<class T, class A, class C, class G>
+typename vector<T,A,C,G>::iterator vector<T,A,C,G>::erase(typename vector<T,A,C,G>::iterator first, typename vector<T,A,C,G>::iterator last)
+{
+    int n = last - first;
+    if(n<=0) return first;
+    if(first==begin()){     // dropping a prefix just widens the front gap
+        for(iterator pos=first ; pos!=last ; ++pos) alloc.destroy(pos);
+        elem += n; head += n;
+        sz -= n; space -= n;
+        reclaim_if_empty();
+        return begin();
+    }
+    C::stats::shifted(end()-last);
+    if(trivial_relocate::value){
+        for(iterator pos=first ; pos!=last ; ++pos) alloc.destroy(pos);
+        std::memmove(static_cast<void*>(first),static_cast<void*>(last),(end()-last)*sizeof(T));
+    }
+    else{
+        std::move(last,end(),first);
+        for(iterator pos=end()-n ; pos!=end() ; ++pos) alloc.destroy(pos);
+    }
+    sz -= n;
+    return first;
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::clear()
+{
+    destroy_range(elem,sz);
+    sz = 0;
+    reclaim_if_empty();
+}
+
+template<class T, class A, class C, class G>
+template<class It, class>
+void vector<T,A,C,G>::assign(It first, It last)
+{
+    assign(first,last,typename std::iterator_traits<It>::iterator_category());
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::assign(int n, const T& val)
+{
+    T tmp(val);
+    fill_iterator f = { &tmp };
+    assign(f,f,std::forward_iterator_tag(),n);     // the count bounds the copy, not last
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+void vector<T,A,C,G>::assign(It first, It last, std::input_iterator_tag)
+{
+    clear();
+    for( ; first!=last ; ++first) emplace_back(*first);
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+void vector<T,A,C,G>::assign(It first, It last, std::forward_iterator_tag)
+{
+    assign(first,last,std::forward_iterator_tag(),int(std::distance(first,last)));
+}
+
+template<class T, class A, class C, class G>
+template<class It>
+void vector<T,A,C,G>::assign(It first, It, std::forward_iterator_tag, int n)
+{
+    if(n<=head+space || grow_in_place(head,n,trivial_realloc())){
+        // fits the block: slide back over the front gap, assign over live
+        // elements, construct the rest, destroy the surplus
+        if(space<n) clear();    // slides elem back over the front gap
+        typedef std::integral_constant<bool, trivial_copy::value
+                                      && std::is_convertible<It,const T*>::value> bulk;
+        if(bulk::value){    // one memcpy over whatever was there
+            construct_range(elem,first,n,bulk());
+            sz = n;
+            return;
+        }
+        int common = sz<n ? sz : n;
+        for(int i=0 ; i<common ; ++i, ++first) elem[i] = *first;
+        if(sz<n){
+            construct_range(elem+sz,first,n-sz);
+        }
+        else{
+            for(int i=n ; i<sz ; ++i) alloc.destroy(&elem[i]);
+        }
+        sz = n;
+        return;
+    }
+
+    buffer_guard<T,A> block(alloc,n);
+    note_block(n,false);
+    construct_range(block.get(),first,n);
+    destroy_range(elem,sz);
+    gen.bump();
+    alloc.deallocate(elem-head,head+space);
+    elem = block.release();
+    sz = space = n;
+    head = 0;
+}
+
+template<class T, class A, class C, class G>
+void vector<T,A,C,G>::resize(int newsize, T val)
+{
+    if(newsize<0) return;
+    reserve(newsize);       // handle newsize<=space and space<newsize
+    for(int i=sz ; i<newsize ; ++i) alloc.construct(&elem[i],val);    // implicitely handle newsize<=size && size<newsize
+    for(int i=newsize ; i<sz ; ++i) alloc.destroy(&elem[i]);
+    sz = newsize;   // handle newsize<size
+    reclaim_if_empty();
+}
+
+#endif // VECTOR_H
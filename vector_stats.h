@@ -0,0 +1,161 @@
+#ifndef VECTOR_STATS_H
+#define VECTOR_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "vector.h"
+
+// opt-in counters for vector: give it instrumented<Tag> as its checking
+// policy and every vector of that type adds to the counters named
+// Tag::name(). the policy checks like Check does (range failures are counted
+// before Check sees them); -DVECTOR_NO_STATS turns every instrumented<>
+// back into its Check, for builds that must not pay for it
+//
+//  struct orders_tag { static const char* name() { return "orders"; } };
+//  vector<Order,std::allocator<Order>,instrumented<orders_tag> > orders;
+//  ...
+//  vector_stats_registry::instance().dump_json(std::cerr);
+
+// one set of counters; relaxed atomics, so vectors on several threads can share it
+struct vector_counters {
+    explicit vector_counters(const char* n);
+
+    void reset()
+    {
+        allocations = 0;
+        bytes_allocated = 0;
+        reallocations = 0;
+        elements_shifted = 0;
+        capacity_high_water = 0;
+        range_failures = 0;
+    }
+
+    const char* name;
+    std::atomic<long long> allocations;
+    std::atomic<long long> bytes_allocated;
+    std::atomic<long long> reallocations;        // blocks replaced with the elements moved over
+    std::atomic<long long> elements_shifted;     // by insert and erase inside the block
+    std::atomic<long long> capacity_high_water;  // biggest block, in bytes
+    std::atomic<long long> range_failures;       // failed checked_iterator/checked_range checks
+};
+
+// every vector_counters in the program, in the order they were first used
+class vector_stats_registry {
+public:
+    static vector_stats_registry& instance()
+    {
+        static vector_stats_registry r;
+        return r;
+    }
+
+    void add(vector_counters* c)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        all.push_back(c);
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m);
+        for(std::size_t i=0 ; i<all.size() ; ++i) all[i]->reset();
+    }
+
+    // {"vectors":[{"name":"orders","allocations":3,...},...]}
+    void dump_json(std::ostream& os) const
+    {
+        std::lock_guard<std::mutex> lock(m);
+        os << "{\"vectors\":[";
+        for(std::size_t i=0 ; i<all.size() ; ++i){
+            const vector_counters& c = *all[i];
+            os << (i ? ",{" : "{") << "\"name\":\"";
+            for(const char* p=c.name ; *p ; ++p){
+                if(*p=='"' || *p=='\\') os << '\\';
+                os << *p;
+            }
+            os << "\",\"allocations\":" << c.allocations.load()
+               << ",\"bytes_allocated\":" << c.bytes_allocated.load()
+               << ",\"reallocations\":" << c.reallocations.load()
+               << ",\"elements_shifted\":" << c.elements_shifted.load()
+               << ",\"capacity_high_water\":" << c.capacity_high_water.load()
+               << ",\"range_failures\":" << c.range_failures.load() << "}";
+        }
+        os << "]}";
+    }
+
+    std::string json() const
+    {
+        std::ostringstream s;
+        dump_json(s);
+        return s.str();
+    }
+
+private:
+    vector_stats_registry() {}
+
+    mutable std::mutex m;
+    std::vector<vector_counters*> all;     // std::vector: the registry must not count itself
+
+    vector_stats_registry(const vector_stats_registry&);
+    vector_stats_registry& operator=(const vector_stats_registry&);
+};
+
+inline vector_counters::vector_counters(const char* n) : name(n)
+{
+    reset();
+    vector_stats_registry::instance().add(this);
+}
+
+// the stats side of the policy: the counters of Tag, made and registered on first use
+template<class Tag>
+struct counting_stats {
+    static vector_counters& counters()
+    {
+        static vector_counters c(Tag::name());
+        return c;
+    }
+
+    static void allocated(std::size_t bytes)
+    {
+        vector_counters& c = counters();
+        c.allocations.fetch_add(1,std::memory_order_relaxed);
+        c.bytes_allocated.fetch_add((long long)bytes,std::memory_order_relaxed);
+    }
+
+    static void reallocated() { counters().reallocations.fetch_add(1,std::memory_order_relaxed); }
+    static void shifted(long n) { if(n>0) counters().elements_shifted.fetch_add(n,std::memory_order_relaxed); }
+    static void range_failure() { counters().range_failures.fetch_add(1,std::memory_order_relaxed); }
+
+    static void capacity(std::size_t bytes)
+    {
+        std::atomic<long long>& hw = counters().capacity_high_water;
+        long long seen = hw.load(std::memory_order_relaxed);
+        while(seen<(long long)bytes && !hw.compare_exchange_weak(seen,(long long)bytes,std::memory_order_relaxed)) {}
+    }
+};
+
+#ifndef VECTOR_NO_STATS
+
+template<class Tag, class Check = VECTOR_CHECK_POLICY>
+struct instrumented : Check {
+    typedef counting_stats<Tag> stats;
+
+    static void check(bool ok, const char* where, const char* what, long index = 0, long offset = 0)
+    {
+        if(!ok) stats::range_failure();
+        Check::check(ok,where,what,index,offset);
+    }
+};
+
+#else
+
+template<class Tag, class Check = VECTOR_CHECK_POLICY>
+struct instrumented : Check {};
+
+#endif
+
+#endif // VECTOR_STATS_H